@@ -76,6 +76,11 @@ bool Update(pntr_app* application, pntr_image* screen) {
     return true;
 }
 
+void Event(pntr_app* application, pntr_app_event* event) {
+    AppData* app = (AppData*)pntr_app_userdata(application);
+    pntr_nuklear_event(app->ctx, application, event);
+}
+
 void Close(pntr_app* application) {
     AppData* app = (AppData*)pntr_app_userdata(application);
     pntr_unload_nuklear(app->ctx);
@@ -89,6 +94,7 @@ pntr_app Main(int argc, char* argv[]) {
         .title = "pntr_nuklear: Example",
         .init = Init,
         .update = Update,
+        .event = Event,
         .close = Close,
         .fps = 60,
         .userData = pntr_load_memory(sizeof(AppData)),
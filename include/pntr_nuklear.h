@@ -45,6 +45,7 @@
 #define NK_COS PNTR_COSF
 #define NK_SQRT PNTR_SQRTF
 #define NK_BUTTON_TRIGGER_ON_RELEASE
+#define NK_ZERO_COMMAND_MEMORY
 
 // Include Nuklear
 #ifndef PNTR_NUKLEAR_NUKLEAR_H
@@ -62,13 +63,20 @@ extern "C" {
 
 #ifdef PNTR_APP_API
 #define PNTR_APP_TYPE pntr_app
+#define PNTR_APP_EVENT_TYPE pntr_app_event
 #else
 #define PNTR_APP_TYPE void
+#define PNTR_APP_EVENT_TYPE void
 #endif
 
 /**
  * Initialize the nuklear pntr context.
  *
+ * Each context keeps its own input, caches, scratch memory and counters, so separate contexts may be driven from
+ * different threads.
+ *
+ * The context's Nuklear font keeps pntr_nuklear's font state in its `userdata.ptr`, rather than the pntr_font.
+ *
  * @param font The font to use when rendering text. Required.
  *
  * @return The new nuklear context, or NULL on failure.
@@ -77,6 +85,64 @@ extern "C" {
  */
 PNTR_NUKLEAR_API struct nk_context* pntr_load_nuklear(pntr_font* font);
 
+/**
+ * Initialize the nuklear pntr context, keeping Nuklear's commands and windows in the given block of memory.
+ *
+ * Nuklear never allocates memory of its own in this mode, so frames make no heap allocations once the
+ * renderer's buffers have grown to fit them. When a frame needs more than the block holds, it is not drawn, and
+ * the draw functions return false.
+ *
+ * @param font The font to use when rendering text. Required.
+ * @param memory The block of memory for Nuklear to use, which must outlive the context.
+ * @param size The size of the block, in bytes.
+ *
+ * @return The new nuklear context, or NULL on failure.
+ *
+ * @see pntr_nuklear_get_memory_used()
+ * @see pntr_unload_nuklear()
+ */
+PNTR_NUKLEAR_API struct nk_context* pntr_load_nuklear_fixed(pntr_font* font, void* memory, nk_size size);
+
+/**
+ * Retrieves how much of Nuklear's memory the last drawn frame needed, in bytes.
+ *
+ * For contexts created with pntr_load_nuklear_fixed(), this is more than the size of the block when the frame ran
+ * out of memory, and tells how large the block should be.
+ *
+ * @param ctx The nuklear context, created with pntr_load_nuklear().
+ *
+ * @return The number of bytes the last frame needed.
+ */
+PNTR_NUKLEAR_API nk_size pntr_nuklear_get_memory_used(struct nk_context* ctx);
+
+/**
+ * Where a nuklear context gets its memory from, and how its command buffer is sized.
+ *
+ * Rather than growing a little at a time as frames get busier, the command buffer is kept large enough for the
+ * most memory any of the recent frames needed. Fields left as zero use the defaults.
+ *
+ * @see pntr_load_nuklear_ex()
+ */
+typedef struct pntr_nuklear_allocator {
+    struct nk_allocator allocator; // Allocates Nuklear's memory, never asked to reallocate. Uses pntr_load_memory() when alloc is NULL.
+    int historyFrames;             // How many recent frames the command buffer fits. Defaults to `PNTR_NUKLEAR_MEMORY_HISTORY`.
+    nk_size growStep;              // The command buffer grows in multiples of this many bytes. Defaults to `PNTR_NUKLEAR_MEMORY_STEP`.
+    int shrinkAfter;               // Frames the command buffer is larger than needed before shrinking it, or 0 to never shrink.
+} pntr_nuklear_allocator;
+
+/**
+ * Initialize the nuklear pntr context, with the given allocator for Nuklear's memory.
+ *
+ * @param font The font to use when rendering text. Required.
+ * @param allocator Where Nuklear's memory comes from, and how its command buffer is sized. NULL uses the defaults.
+ *
+ * @return The new nuklear context, or NULL on failure.
+ *
+ * @see pntr_load_nuklear()
+ * @see pntr_unload_nuklear()
+ */
+PNTR_NUKLEAR_API struct nk_context* pntr_load_nuklear_ex(pntr_font* font, const pntr_nuklear_allocator* allocator);
+
 /**
  * Unloads the given nuklear context.
  *
@@ -91,6 +157,8 @@ PNTR_NUKLEAR_API void pntr_unload_nuklear(struct nk_context* ctx);
  *
  * The pntr_app integration is optional, and only used if pntr_app is included before pntr_nuklear.
  *
+ * The context's clipboard is pointed at pntr_app, unless the application set its own `ctx->clip` handlers.
+ *
  * @see https://github.com/robloach/pntr_app
  *
  * @param ctx The nuklear context to handle the event.
@@ -98,13 +166,308 @@ PNTR_NUKLEAR_API void pntr_unload_nuklear(struct nk_context* ctx);
  */
 PNTR_NUKLEAR_API void pntr_nuklear_update(struct nk_context* ctx, PNTR_APP_TYPE* app);
 
+/**
+ * Passes a pntr_app event on to Nuklear, as it arrives.
+ *
+ * Keys, typed characters, mouse buttons, motion and the mouse wheel are each translated once, so that keystrokes
+ * and clicks between two frames are not lost. Once events are passed on, pntr_nuklear_update() no longer polls the
+ * keyboard and mouse, and only updates the time and clipboard.
+ *
+ * @code
+ * void Event(pntr_app* app, pntr_app_event* event) {
+ *     pntr_nuklear_event(ctx, app, event);
+ * }
+ * @endcode
+ *
+ * @param ctx The nuklear context to handle the event.
+ * @param app The pntr_app the event came from.
+ * @param event The event to pass on.
+ *
+ * @see pntr_nuklear_update()
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_event(struct nk_context* ctx, PNTR_APP_TYPE* app, PNTR_APP_EVENT_TYPE* event);
+
 /**
  * Draws the given nuklear context on the destination image.
  *
+ * Contexts set up with Nuklear's own nk_init functions are drawn too, command by command, without any of the
+ * caching, culling or frame skipping that contexts created with pntr_load_nuklear() get. The other pntr_nuklear
+ * functions need a context created with pntr_load_nuklear(); the draw functions fall back to this for other
+ * contexts, and the rest leave them as they are.
+ *
+ * Images given to nk_image() that are drawn at another size are rescaled once and cached by their pointer. When
+ * such an image changes its pixels in place, or is unloaded and a new one happens to get the same address, call
+ * pntr_nuklear_invalidate_image() before the next draw, or the old pixels are drawn.
+ *
  * @param dst The destination image to render to.
  * @param ctx The nuklear context to render.
+ *
+ * @return True when the image was drawn, false when it was skipped because nothing changed, or because the frame
+ *         ran out of memory.
+ *
+ * @see pntr_nuklear_set_skip_unchanged()
+ * @see pntr_nuklear_invalidate_image()
+ */
+PNTR_NUKLEAR_API bool pntr_draw_nuklear(pntr_image* dst, struct nk_context* ctx);
+
+/**
+ * Draws the given nuklear context on the destination image, splitting the work across threads.
+ *
+ * Each command is binned into the screen tiles it touches, and the tiles are rasterized in parallel, each one
+ * clipped to its own area. The output is the same as pntr_draw_nuklear(). Custom commands run on the calling
+ * thread, in order, once the tiles have drawn everything before them.
+ *
+ * Threads are only used when `PNTR_NUKLEAR_ENABLE_THREADS` is defined, which requires pthreads. Otherwise, the
+ * tiles are drawn one after the other. The threads are started the first time they're needed, and shared by every
+ * context until the last one is unloaded.
+ *
+ * @param dst The destination image to render to.
+ * @param ctx The nuklear context to render, created with pntr_load_nuklear().
+ * @param threads The number of threads to use, including the calling thread.
+ *
+ * @return True when the image was drawn, false when it was skipped because nothing changed, or because the frame
+ *         ran out of memory.
+ *
+ * @see pntr_draw_nuklear()
+ */
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_tiled(pntr_image* dst, struct nk_context* ctx, int threads);
+
+/**
+ * Draws many independent nuklear contexts, each on its own image, spreading the contexts across threads.
+ *
+ * Each context is drawn with pntr_draw_nuklear(), using only its own state, so each context and image may only
+ * appear once. Custom commands may run on any of the threads.
+ *
+ * Threads are only used when `PNTR_NUKLEAR_ENABLE_THREADS` is defined, which requires pthreads. Otherwise, the
+ * contexts are drawn one after the other. The same worker threads as pntr_draw_nuklear_tiled() are used.
+ *
+ * @param images The destination image of each context.
+ * @param contexts The nuklear contexts to render, created with pntr_load_nuklear().
+ * @param count The number of contexts and images.
+ * @param threads The number of threads to use, including the calling thread.
+ *
+ * @return The number of images that were drawn, leaving out the ones skipped by pntr_draw_nuklear().
+ *
+ * @see pntr_draw_nuklear()
+ */
+PNTR_NUKLEAR_API int pntr_draw_nuklear_batch(pntr_image** images, struct nk_context** contexts, int count, int threads);
+
+/**
+ * A job system's parallel for loop, used by pntr_draw_nuklear_parallel().
+ *
+ * It must call `job(data, index)` once for each index from 0 to `count`, in any order and on any threads, and
+ * only return once all of them are done.
+ *
+ * @param user The user data given to pntr_draw_nuklear_parallel().
+ * @param count The number of jobs.
+ * @param job The job to run for each index.
+ * @param data The data to pass to the job.
+ */
+typedef void (*pntr_nuklear_parallel_for)(void* user, int count, void (*job)(void* data, int index), void* data);
+
+/**
+ * Draws the given nuklear context on the destination image, split into horizontal bands run on the caller's job
+ * system.
+ *
+ * Each band draws every command that touches it, clipped to the band. The output is the same as
+ * pntr_draw_nuklear(). Custom commands run on the calling thread, in order, once the bands have drawn everything
+ * before them, so `parallelFor` is called once for each run of commands between them.
+ *
+ * @param dst The destination image to render to.
+ * @param ctx The nuklear context to render, created with pntr_load_nuklear().
+ * @param parallelFor The job system's parallel for loop. When NULL, the bands are drawn one after the other.
+ * @param user The user data passed to `parallelFor`.
+ *
+ * @return True when the image was drawn, false when it was skipped because nothing changed, or because the frame
+ *         ran out of memory.
+ *
+ * @see pntr_draw_nuklear_tiled()
+ */
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_parallel(pntr_image* dst, struct nk_context* ctx, pntr_nuklear_parallel_for parallelFor, void* user);
+
+/**
+ * Starts drawing the given nuklear context on a render thread, so that the next frame can be built meanwhile.
+ *
+ * The finished commands are copied into a frame packet, and the context is ready for the next nk_begin() as soon as
+ * this returns. The frame is drawn on `dst` in the background, so `dst` must not be used until pntr_nuklear_wait()
+ * returns. Any earlier frame still being drawn is waited for first, as it is by the other draw functions.
+ *
+ * Images given to nk_image() must stay unchanged until the frame is drawn, and custom commands run on the render
+ * thread. Unchanged frames are never skipped.
+ *
+ * The render thread is only used when `PNTR_NUKLEAR_ENABLE_THREADS` is defined, which requires pthreads.
+ * Otherwise, the frame is drawn before this returns. Each context starts its render thread the first time this is
+ * called, and keeps it until the context is unloaded.
+ *
+ * @param dst The destination image to render to.
+ * @param ctx The nuklear context to render, created with pntr_load_nuklear().
+ *
+ * @return True when the frame is being drawn, false when it ran out of memory.
+ *
+ * @see pntr_nuklear_wait()
+ */
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_async(pntr_image* dst, struct nk_context* ctx);
+
+/**
+ * Waits for the frame started with pntr_draw_nuklear_async() to be drawn.
+ *
+ * @param ctx The nuklear context, created with pntr_load_nuklear().
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_wait(struct nk_context* ctx);
+
+/**
+ * Draws the given nuklear context on the destination image, keeping each window in its own cached layer.
+ *
+ * Only the windows whose commands changed are re-rasterized. The layers are then composited onto `dst` in
+ * z-order, so moving a window only moves its layer. Windows that leave any pixel partly transparent, like those
+ * with translucent styles or anti-aliased text over nothing, are drawn directly each frame instead, so that their
+ * alpha isn't applied twice. Windows with custom commands are also drawn directly, running each custom command in
+ * its place among the window's commands.
+ *
+ * @param dst The destination image to render to.
+ * @param ctx The nuklear context to render, created with pntr_load_nuklear().
+ *
+ * @return True when the image was drawn, false when it was skipped because nothing changed, or because the frame
+ *         ran out of memory.
+ *
+ * @see pntr_draw_nuklear()
+ */
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_layered(pntr_image* dst, struct nk_context* ctx);
+
+/**
+ * Skip drawing in pntr_draw_nuklear() when the commands are the same as the last drawn frame.
+ *
+ * When enabled, `dst` must keep the last frame's pixels rather than being cleared by the caller. Hosts can use
+ * the result of pntr_draw_nuklear() to skip presenting the frame.
+ *
+ * @param ctx The nuklear context, created with pntr_load_nuklear().
+ * @param skip Whether or not unchanged frames are skipped. Disabled by default.
+ *
+ * @see pntr_nuklear_invalidate()
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_set_skip_unchanged(struct nk_context* ctx, bool skip);
+
+/**
+ * Draws only what changed in the nuklear context since the last incremental draw.
+ *
+ * The commands are compared to the previous frame's, and only the damaged rectangles are cleared to the
+ * background color and re-rasterized. Everything else in `dst` is left untouched, so `dst` must keep the
+ * previous frame's pixels rather than being cleared by the caller.
+ *
+ * @param dst The destination image to render to.
+ * @param ctx The nuklear context to render, created with pntr_load_nuklear().
+ * @param background The color used to clear the damaged areas.
+ *
+ * @return True when pixels were redrawn, false when nothing changed or the frame ran out of memory.
+ *
+ * @see pntr_nuklear_invalidate()
+ */
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_incremental(pntr_image* dst, struct nk_context* ctx, pntr_color background);
+
+/**
+ * Forces the next draw to redraw the whole image, even when nothing changed.
+ *
+ * Needed when an image given to nk_image() changes its pixels in place, or when something else drew on `dst`.
+ *
+ * @param ctx The nuklear context to invalidate.
+ *
+ * @see pntr_draw_nuklear_incremental()
+ * @see pntr_nuklear_invalidate_image()
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_invalidate(struct nk_context* ctx);
+
+/**
+ * Forgets the rescaled copies of an image, and forces the next draw to redraw the whole image.
+ *
+ * Call this after changing the pixels of an image given to nk_image(), or after unloading one, as the cached copies
+ * are found by the image's pointer. Copies of other images are kept, unlike with pntr_nuklear_invalidate().
+ *
+ * @param ctx The nuklear context that draws the image.
+ * @param image The image that changed.
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_invalidate_image(struct nk_context* ctx, pntr_image* image);
+
+/**
+ * Changes the font used by the nuklear context.
+ *
+ * The text widths measured with the previous font are forgotten, and the next draw redraws everything.
+ *
+ * @param ctx The nuklear context, created with pntr_load_nuklear().
+ * @param font The font to use. It must outlive the context, or the next call to pntr_nuklear_set_font().
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_set_font(struct nk_context* ctx, pntr_font* font);
+
+/**
+ * Sets how far, in pixels, flattened curves and arcs may stray from the real shape.
+ *
+ * Curves and arcs are split into as few line segments as this allows, so larger tolerances draw faster with
+ * coarser shapes. Defaults to `PNTR_NUKLEAR_CURVE_TOLERANCE`, a quarter of a pixel.
+ *
+ * @param ctx The nuklear context, created with pntr_load_nuklear().
+ * @param tolerance The distance in pixels. Must be greater than zero.
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_set_curve_tolerance(struct nk_context* ctx, float tolerance);
+
+/**
+ * Counters of the work done by a nuklear context, since it was loaded or the counters were reset.
+ *
+ * @see pntr_nuklear_get_stats()
+ */
+typedef struct pntr_nuklear_stats {
+    unsigned int textCacheHits;     // Text widths found in the text width cache.
+    unsigned int textCacheMisses;   // Text widths that had to be measured and cached.
+    unsigned int culledCommands;    // Commands skipped because a later opaque rectangle covered them.
+    unsigned int droppedCommands;   // No-ops, redundant scissors, and invisible or fully clipped commands skipped.
+    unsigned int imageCacheHits;    // Rescaled images found in the image cache.
+    unsigned int imageCacheMisses;  // Rescaled images that had to be made and cached.
+} pntr_nuklear_stats;
+
+/**
+ * Retrieves the counters of the work done by the given nuklear context.
+ *
+ * @param ctx The nuklear context, created with pntr_load_nuklear().
+ *
+ * @return The counters, or all zeroes when `ctx` is NULL.
+ *
+ * @see pntr_nuklear_reset_stats()
+ */
+PNTR_NUKLEAR_API pntr_nuklear_stats pntr_nuklear_get_stats(struct nk_context* ctx);
+
+/**
+ * Sets the counters of the work done by the given nuklear context back to zero.
+ *
+ * @param ctx The nuklear context, created with pntr_load_nuklear().
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_reset_stats(struct nk_context* ctx);
+
+/**
+ * How much memory a nuklear context's Nuklear state is using, and how it got there.
+ *
+ * The allocation counters only cover memory allocated through the context's allocator, so they stay at zero for
+ * contexts created with pntr_load_nuklear_fixed(), as does the page pool.
+ *
+ * @see pntr_nuklear_get_memory_stats()
+ */
+typedef struct pntr_nuklear_memory_stats {
+    nk_size liveBytes;                  // Bytes allocated and not freed yet.
+    nk_size peakBytes;                  // The most bytes allocated at once.
+    unsigned int allocations;           // Times memory was allocated.
+    unsigned int frees;                 // Times memory was freed.
+    nk_size commandBufferUsed;          // Bytes of the command buffer the last drawn frame needed.
+    nk_size commandBufferSize;          // Bytes the command buffer has room for.
+    unsigned int pageElementsUsed;      // Windows, panels and tables held in Nuklear's page pool.
+    unsigned int pageElementsAllocated; // Room for page elements in the pages allocated for the pool.
+    unsigned int windowCount;           // Windows Nuklear keeps, including hidden and closed ones not freed yet.
+} pntr_nuklear_memory_stats;
+
+/**
+ * Retrieves how much memory the given nuklear context's Nuklear state is using.
+ *
+ * @param ctx The nuklear context, created with pntr_load_nuklear().
+ *
+ * @return The memory counters, or all zeroes when `ctx` is NULL.
  */
-PNTR_NUKLEAR_API void pntr_draw_nuklear(pntr_image* dst, struct nk_context* ctx);
+PNTR_NUKLEAR_API pntr_nuklear_memory_stats pntr_nuklear_get_memory_stats(struct nk_context* ctx);
 PNTR_NUKLEAR_API struct nk_rect pntr_rectangle_to_nk_rect(pntr_rectangle rectangle);
 PNTR_NUKLEAR_API pntr_color pntr_nk_color_to_color(struct nk_color color);
 PNTR_NUKLEAR_API struct nk_color pntr_color_to_nk_color(pntr_color color);
@@ -118,6 +481,10 @@ PNTR_NUKLEAR_API pntr_color pntr_nk_colorf_to_color(struct nk_colorf color);
  * nk_image(ctx, pntr_image_nk(app->image));
  * @endcode
  *
+ * The image is referenced by its pointer, which is also how its rescaled copies are cached. Call
+ * pntr_nuklear_invalidate_image() after changing its pixels, or after unloading it while the context is still used.
+ *
+ * @see pntr_nuklear_invalidate_image()
  * @see nk_image()
  * @see pntr_load_image()
  */
@@ -154,87 +521,1021 @@ PNTR_NUKLEAR_API void pntr_nuklear_draw_polygon_fill(pntr_image* dst, const stru
 #endif
 #include PNTR_NUKLEAR_NUKLEAR_H
 
+#ifdef PNTR_NUKLEAR_ENABLE_THREADS
+#include <pthread.h>
+#endif
+
+// Vectorized fills, unless PNTR_NUKLEAR_DISABLE_SIMD is defined.
+#ifndef PNTR_NUKLEAR_DISABLE_SIMD
+    #if defined(__AVX2__)
+        #include <immintrin.h>
+        #define PNTR_NUKLEAR_AVX2
+        #define PNTR_NUKLEAR_SSE2
+    #elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+        #include <emmintrin.h>
+        #define PNTR_NUKLEAR_SSE2
+    #endif
+#endif
+
 #ifdef __cplusplus
 extern "C" {
 #endif
 
 /**
- * Nuklear callback to calculate the width of the given text.
- *
- * @internal
- * @private
+ * Maximum number of damage rectangles kept for an incremental draw. Once reached, the closest
+ * rectangles are merged together.
  */
-static float _pntr_nuklear_text_width(nk_handle font, float height, const char* text, int len) {
-    NK_UNUSED(height);
-    pntr_font* pntrFont = (pntr_font*)font.ptr;
-    return (float)pntr_measure_text_ex(pntrFont, text, len).x;
-}
+#ifndef PNTR_NUKLEAR_MAX_DAMAGE_RECTS
+#define PNTR_NUKLEAR_MAX_DAMAGE_RECTS 16
+#endif
 
-static void* pntr_nuklear_alloc(nk_handle handle, void *old, nk_size size) {
-    NK_UNUSED(handle);
-    NK_UNUSED(old);
-    return pntr_load_memory((size_t)size);
-}
+/**
+ * How many of the previous frame's commands are searched ahead when matching up an unchanged command.
+ */
+#ifndef PNTR_NUKLEAR_DAMAGE_LOOKAHEAD
+#define PNTR_NUKLEAR_DAMAGE_LOOKAHEAD 256
+#endif
 
-static void pntr_nuklear_free(nk_handle handle, void *old) {
-    NK_UNUSED(handle);
-    if (old != NULL) {
-        pntr_unload_memory(old);
-        (void)nk_inv_sqrt;
-    }
-}
+/**
+ * Width and height of the screen tiles used by pntr_draw_nuklear_tiled().
+ */
+#ifndef PNTR_NUKLEAR_TILE_SIZE
+#define PNTR_NUKLEAR_TILE_SIZE 128
+#endif
 
-#ifdef PNTR_APP_API
 /**
- * Nuklear callback; Paste the current clipboard.
+ * Least height, in pixels, of the bands that pntr_draw_nuklear_parallel() splits the image into.
+ */
+#ifndef PNTR_NUKLEAR_BAND_HEIGHT
+#define PNTR_NUKLEAR_BAND_HEIGHT 32
+#endif
+
+/**
+ * Maximum number of threads used to draw a context.
+ */
+#ifndef PNTR_NUKLEAR_MAX_THREADS
+#define PNTR_NUKLEAR_MAX_THREADS 64
+#endif
+
+/**
+ * Maximum number of opaque rectangles tracked when culling covered commands. The largest ones are kept.
+ */
+#ifndef PNTR_NUKLEAR_MAX_OCCLUDERS
+#define PNTR_NUKLEAR_MAX_OCCLUDERS 32
+#endif
+
+/**
+ * The default distance, in pixels, that flattened curves and arcs may stray from the real shape.
  *
- * @internal
+ * @see pntr_nuklear_set_curve_tolerance()
  */
-static void
-pntr_nuklear_clipboard_paste(nk_handle usr, struct nk_text_edit *edit)
-{
-    const char* text = pntr_app_clipboard((pntr_app*)usr.ptr);
-    if (text != NULL) {
-        nk_textedit_paste(edit, text, PNTR_STRLEN(text));
-    }
-}
+#ifndef PNTR_NUKLEAR_CURVE_TOLERANCE
+#define PNTR_NUKLEAR_CURVE_TOLERANCE 0.25f
+#endif
 
 /**
- * Nuklear callback; Copy the given text.
+ * The default number of recent frames that a context's command buffer is kept large enough for.
  *
- * @internal
+ * @see pntr_load_nuklear_ex()
  */
-static void
-pntr_nuklear_clipboard_copy(nk_handle usr, const char *text, int len)
-{
-    pntr_app_set_clipboard((pntr_app*)usr.ptr, text, len);
-}
+#ifndef PNTR_NUKLEAR_MEMORY_HISTORY
+#define PNTR_NUKLEAR_MEMORY_HISTORY 60
+#endif
 
 /**
- * Fallback translation from a pntr_app key press to a printable character, assuming a US QWERTY layout.
+ * Most recent frames that a context's command buffer may be kept large enough for.
+ */
+#ifndef PNTR_NUKLEAR_MAX_MEMORY_HISTORY
+#define PNTR_NUKLEAR_MAX_MEMORY_HISTORY 240
+#endif
+
+/**
+ * The default number of bytes that a context's command buffer grows by at a time.
  *
- * Override `PNTR_NUKLEAR_KEY_CHAR(app, key, shift)` before including pntr_nuklear.h to
- * delegate to a layout-aware platform API (AZERTY, QWERTZ, Dvorak, etc.).
- * Returns 0 when the key does not produce a printable character.
+ * @see pntr_load_nuklear_ex()
+ */
+#ifndef PNTR_NUKLEAR_MEMORY_STEP
+#define PNTR_NUKLEAR_MEMORY_STEP (16 * 1024)
+#endif
+
+/**
+ * Most line segments a single curve or arc is flattened into.
+ */
+#ifndef PNTR_NUKLEAR_MAX_CURVE_SEGMENTS
+#define PNTR_NUKLEAR_MAX_CURVE_SEGMENTS 256
+#endif
+
+/**
+ * Number of rescaled images each context keeps, for images drawn at the same size every frame.
  *
- * @internal
+ * Frames drawing more than this keep all of their images for as long as they draw them.
  */
-static char pntr_nuklear_default_key_char(pntr_app_key key, bool shift) {
-    if (key >= PNTR_APP_KEY_A && key <= PNTR_APP_KEY_Z) {
-        return shift ? (char)key : (char)(key + 32);
-    }
-    if (key >= PNTR_APP_KEY_KP_0 && key <= PNTR_APP_KEY_KP_9) {
-        return (char)(key - PNTR_APP_KEY_KP_0 + '0');
-    }
-    switch (key) {
-        case PNTR_APP_KEY_SPACE:         return ' ';
-        case PNTR_APP_KEY_APOSTROPHE:    return shift ? '"' : '\'';
-        case PNTR_APP_KEY_COMMA:         return shift ? '<' : ',';
-        case PNTR_APP_KEY_MINUS:         return shift ? '_' : '-';
-        case PNTR_APP_KEY_PERIOD:        return shift ? '>' : '.';
-        case PNTR_APP_KEY_SLASH:         return shift ? '?' : '/';
-        case PNTR_APP_KEY_0:             return shift ? ')' : '0';
-        case PNTR_APP_KEY_1:             return shift ? '!' : '1';
+#ifndef PNTR_NUKLEAR_IMAGE_CACHE_SIZE
+#define PNTR_NUKLEAR_IMAGE_CACHE_SIZE 16
+#endif
+
+/**
+ * Largest rescaled image, in pixels, that is kept in the image cache.
+ */
+#ifndef PNTR_NUKLEAR_IMAGE_CACHE_MAX_PIXELS
+#define PNTR_NUKLEAR_IMAGE_CACHE_MAX_PIXELS (512 * 512)
+#endif
+
+/**
+ * Number of images each context keeps downscaled copies of, for images drawn much smaller than they are.
+ *
+ * Frames drawing more than this keep all of their copies for as long as they draw them.
+ */
+#ifndef PNTR_NUKLEAR_MIPMAP_CACHE_SIZE
+#define PNTR_NUKLEAR_MIPMAP_CACHE_SIZE 256
+#endif
+
+/**
+ * Most times an image is halved when drawn smaller than it is.
+ */
+#ifndef PNTR_NUKLEAR_MAX_MIP_LEVELS
+#define PNTR_NUKLEAR_MAX_MIP_LEVELS 16
+#endif
+
+/**
+ * Number of text widths each context remembers across frames. Must be a power of two.
+ */
+#ifndef PNTR_NUKLEAR_TEXT_CACHE_SIZE
+#define PNTR_NUKLEAR_TEXT_CACHE_SIZE 256
+#endif
+
+/**
+ * Longest text, in bytes, that is kept in the text width cache.
+ */
+#ifndef PNTR_NUKLEAR_TEXT_CACHE_MAX_LEN
+#define PNTR_NUKLEAR_TEXT_CACHE_MAX_LEN 64
+#endif
+
+#define PNTR_NUKLEAR_MIN(a, b) (((a) < (b)) ? (a) : (b))
+#define PNTR_NUKLEAR_MAX(a, b) (((a) > (b)) ? (a) : (b))
+
+/**
+ * FNV-1a hash of the given bytes, continuing from the given hash.
+ *
+ * @internal
+ */
+static uint64_t pntr_nuklear_hash(uint64_t hash, const void* data, nk_size size) {
+    const unsigned char* bytes = (const unsigned char*)data;
+    for (nk_size i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+#define PNTR_NUKLEAR_HASH_SEED 0xcbf29ce484222325ULL
+
+/**
+ * Computes the intersection of two rectangles, which has no area when they don't overlap.
+ *
+ * @internal
+ */
+static pntr_rectangle pntr_nuklear_rect_intersect(pntr_rectangle a, pntr_rectangle b) {
+    int x1 = PNTR_NUKLEAR_MAX(a.x, b.x);
+    int y1 = PNTR_NUKLEAR_MAX(a.y, b.y);
+    int x2 = PNTR_NUKLEAR_MIN(a.x + a.width, b.x + b.width);
+    int y2 = PNTR_NUKLEAR_MIN(a.y + a.height, b.y + b.height);
+    return PNTR_CLITERAL(pntr_rectangle) { x1, y1, PNTR_NUKLEAR_MAX(x2 - x1, 0), PNTR_NUKLEAR_MAX(y2 - y1, 0) };
+}
+
+/**
+ * Computes the smallest rectangle containing both rectangles.
+ *
+ * @internal
+ */
+static pntr_rectangle pntr_nuklear_rect_union(pntr_rectangle a, pntr_rectangle b) {
+    int x1 = PNTR_NUKLEAR_MIN(a.x, b.x);
+    int y1 = PNTR_NUKLEAR_MIN(a.y, b.y);
+    int x2 = PNTR_NUKLEAR_MAX(a.x + a.width, b.x + b.width);
+    int y2 = PNTR_NUKLEAR_MAX(a.y + a.height, b.y + b.height);
+    return PNTR_CLITERAL(pntr_rectangle) { x1, y1, x2 - x1, y2 - y1 };
+}
+
+static inline bool pntr_nuklear_rect_empty(pntr_rectangle rect) {
+    return rect.width <= 0 || rect.height <= 0;
+}
+
+static inline bool pntr_nuklear_rect_overlaps(pntr_rectangle a, pntr_rectangle b) {
+    return a.x < b.x + b.width && b.x < a.x + a.width && a.y < b.y + b.height && b.y < a.y + a.height;
+}
+
+static inline bool pntr_nuklear_rect_equals(pntr_rectangle a, pntr_rectangle b) {
+    return a.x == b.x && a.y == b.y && a.width == b.width && a.height == b.height;
+}
+
+static inline bool pntr_nuklear_rect_contains(pntr_rectangle outer, pntr_rectangle inner) {
+    return inner.x >= outer.x && inner.y >= outer.y && inner.x + inner.width <= outer.x + outer.width && inner.y + inner.height <= outer.y + outer.height;
+}
+
+/**
+ * Stores the given color in a run of pixels, without blending.
+ *
+ * @internal
+ */
+static void pntr_nuklear_store_span(pntr_color* pixels, int count, pntr_color color) {
+    int i = 0;
+    #ifdef PNTR_NUKLEAR_AVX2
+    __m256i wide = _mm256_set1_epi32((int)color.value);
+    for (; i + 8 <= count; i += 8) {
+        _mm256_storeu_si256((__m256i*)(void*)(pixels + i), wide);
+    }
+    #endif
+    #ifdef PNTR_NUKLEAR_SSE2
+    __m128i value = _mm_set1_epi32((int)color.value);
+    for (; i + 4 <= count; i += 4) {
+        _mm_storeu_si128((__m128i*)(void*)(pixels + i), value);
+    }
+    #endif
+    for (; i < count; i++) {
+        pixels[i] = color;
+    }
+}
+
+/**
+ * Draws the given color over a run of pixels, the same as pntr_draw_point() would for each of them.
+ *
+ * Opaque colors take the store path. Translucent ones are blended with pntr_blend_color(), so that the result
+ * matches pntr exactly.
+ *
+ * @internal
+ */
+static void pntr_nuklear_fill_span(pntr_color* pixels, int count, pntr_color color) {
+    if (color.rgba.a == 255) {
+        pntr_nuklear_store_span(pixels, count, color);
+    }
+    else if (color.rgba.a > 0) {
+        for (int i = 0; i < count; i++) {
+            pntr_blend_color(pixels + i, color);
+        }
+    }
+}
+
+/**
+ * Fills the given rectangle, clipped to the image's clip area.
+ *
+ * @internal
+ */
+static void pntr_nuklear_fill_rect(pntr_image* dst, pntr_rectangle rect, pntr_color color) {
+    rect = pntr_nuklear_rect_intersect(rect, dst->clip);
+    rect = pntr_nuklear_rect_intersect(rect, PNTR_CLITERAL(pntr_rectangle) { 0, 0, dst->width, dst->height });
+    if (pntr_nuklear_rect_empty(rect) || color.rgba.a == 0) {
+        return;
+    }
+
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        pntr_nuklear_fill_span(dst->data + y * (dst->pitch >> 2) + rect.x, rect.width, color);
+    }
+}
+
+/**
+ * Draws the outline of the given rectangle as four fills that don't overlap.
+ *
+ * @internal
+ */
+static void pntr_nuklear_fill_rect_outline(pntr_image* dst, pntr_rectangle rect, int thickness, pntr_color color) {
+    if (thickness <= 0 || pntr_nuklear_rect_empty(rect)) {
+        return;
+    }
+    if (thickness * 2 >= rect.width || thickness * 2 >= rect.height) {
+        pntr_nuklear_fill_rect(dst, rect, color);
+        return;
+    }
+
+    int inner = rect.height - thickness * 2;
+    pntr_nuklear_fill_rect(dst, PNTR_CLITERAL(pntr_rectangle) { rect.x, rect.y, rect.width, thickness }, color);
+    pntr_nuklear_fill_rect(dst, PNTR_CLITERAL(pntr_rectangle) { rect.x, rect.y + thickness, thickness, inner }, color);
+    pntr_nuklear_fill_rect(dst, PNTR_CLITERAL(pntr_rectangle) { rect.x + rect.width - thickness, rect.y + thickness, thickness, inner }, color);
+    pntr_nuklear_fill_rect(dst, PNTR_CLITERAL(pntr_rectangle) { rect.x, rect.y + rect.height - thickness, rect.width, thickness }, color);
+}
+
+/**
+ * Memory reused from one command to the next, like for converting polygon points.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_scratch {
+    void* memory;
+    size_t capacity;
+} pntr_nuklear_scratch;
+
+/**
+ * A copy of an image, rescaled the way an image command draws it.
+ *
+ * The copy is left untinted, as pntr_draw_image_scaled_rec() tints after rescaling.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_image_cache_entry {
+    pntr_image* source;     // NULL when the entry is empty.
+    pntr_rectangle region;
+    int width;
+    int height;
+    pntr_image* scaled;
+    unsigned int lastUsed;
+} pntr_nuklear_image_cache_entry;
+
+/**
+ * The halved copies of an image, used to draw it much smaller than it is.
+ *
+ * Only the levels that were asked for are kept, so that large images don't keep their larger levels around.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_mipmap {
+    pntr_image* source;
+    int width;              // The size of the source when the levels were made.
+    int height;
+    pntr_image* levels[PNTR_NUKLEAR_MAX_MIP_LEVELS]; // Each level is half the size of the one before it, the source being level 0.
+    unsigned int lastUsed;
+} pntr_nuklear_mipmap;
+
+/**
+ * A drawing command, along with the area it may touch.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_item {
+    const struct nk_command* cmd;
+    uint64_t hash;          // Hash of the command's contents and clip.
+    pntr_rectangle bounds;  // The pixels the command may touch, clipped.
+    pntr_rectangle clip;    // The active scissor.
+} pntr_nuklear_item;
+
+/**
+ * The cached pixels of a window, used by pntr_draw_nuklear_layered().
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_layer {
+    nk_hash name;       // The window's name.
+    uint64_t hash;      // Hash of the window's commands, relative to the layer.
+    pntr_image* image;
+    bool rendered;
+    bool translucent;   // Whether the layer has partly transparent pixels, which are drawn directly instead.
+    bool used;          // Whether the window was drawn this frame.
+} pntr_nuklear_layer;
+
+/**
+ * A measured text width, remembered across frames.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_text_cache_entry {
+    pntr_font* font;
+    int len;                        // Zero when the entry is empty.
+    float width;
+    char text[PNTR_NUKLEAR_TEXT_CACHE_MAX_LEN];
+} pntr_nuklear_text_cache_entry;
+
+/**
+ * A pntr_font wrapped for Nuklear, along with the advance of each ASCII character.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_font {
+    struct nk_user_font userFont; // Must be first, so that the nk_user_font can be cast back.
+    pntr_font* font;
+    int advances[128];
+    bool additive;                // Whether text widths are the sum of the advances.
+    pntr_nuklear_text_cache_entry cache[PNTR_NUKLEAR_TEXT_CACHE_SIZE];
+    unsigned int cacheHits;
+    unsigned int cacheMisses;
+    unsigned char* coverage;      // The alpha of each atlas pixel, or NULL when text is drawn with pntr_draw_text().
+    int glyphs[256];              // The glyph index of each character, or -1 when the font doesn't have it.
+} pntr_nuklear_font;
+
+/**
+ * The state behind each context created with pntr_load_nuklear().
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_context {
+    struct nk_context ctx; // Must be first, so that the nk_context can be cast back.
+    pntr_nuklear_font font;
+
+    // Incremental rendering
+    pntr_nuklear_item* items;
+    int itemCount;
+    int itemCapacity;
+    pntr_nuklear_item* previous;
+    int previousCount;
+    int previousCapacity;
+    pntr_rectangle damage[PNTR_NUKLEAR_MAX_DAMAGE_RECTS];
+    int damageCount;
+    pntr_image* target;
+    int targetWidth;
+    int targetHeight;
+    bool invalidated;
+
+    // How much of Nuklear's memory the last frame needed, and the most recent frames needed.
+    nk_size memoryUsed;
+    pntr_nuklear_allocator allocator;
+    pntr_nuklear_memory_stats memoryStats;
+    nk_size memoryHistory[PNTR_NUKLEAR_MAX_MEMORY_HISTORY];
+    int memoryFrame;
+    int memoryIdleFrames;
+
+    // How far flattened curves may stray from the real shape, in pixels.
+    float curveTolerance;
+
+    // Input, kept for each context so that contexts don't affect each other.
+    bool eventDriven;            // Whether input comes through pntr_nuklear_event() rather than polling.
+    unsigned int modifiers;      // The shift and control keys held down, one bit for each.
+    float doubleClickTimer;      // Seconds since the left mouse button was last pressed.
+
+    // Rescaled images. While locked, threads may only look up images that are already there.
+    pntr_nuklear_image_cache_entry* imageCache;
+    int imageCacheCount;
+    int imageCacheCapacity;
+    unsigned int imageCacheClock;
+    unsigned int imageCacheFrame;   // The clock when the frame started, as images used since then aren't replaced.
+    bool imageCacheLocked;
+    pntr_nuklear_mipmap* mipmaps;
+    int mipmapCount;
+    int mipmapCapacity;
+
+    // Scratch memory for each thread drawing commands, the first being the calling thread's.
+    pntr_nuklear_scratch scratch[PNTR_NUKLEAR_MAX_THREADS];
+
+    // Counters of the work done, along with the font's text cache counters.
+    pntr_nuklear_stats stats;
+
+    // Skipping unchanged frames
+    bool skipUnchanged;
+    uint64_t frameHash;
+    pntr_image* frameTarget;
+
+    // Tiled rendering
+    int* tileStart;
+    int tileStartCapacity;
+    int* tileItems;
+    int tileItemsCapacity;
+
+    // Layered rendering
+    pntr_nuklear_layer* layers;
+    int layerCount;
+    int layerCapacity;
+    unsigned char* layerCommands;
+    int layerCommandsCapacity;
+
+    // Pipelined rendering. The frame packet is only touched by the render thread while it is drawing.
+    unsigned char* frameCommands;
+    int frameCommandsSize;
+    int frameCommandsCapacity;
+    pntr_image* frameDst;
+    bool frameDrawing;           // Guarded by frameMutex once the render thread is started.
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+    bool frameThreadStarted;
+    bool frameQuit;
+    pthread_t frameThread;
+    pthread_mutex_t frameMutex;
+    pthread_cond_t frameWake;
+    pthread_cond_t frameDone;
+    #endif
+} pntr_nuklear_context;
+
+/**
+ * Retrieve the pntr_nuklear state from a context created with pntr_load_nuklear().
+ *
+ * Contexts set up with Nuklear's own nk_init functions have no state. They are told apart without reading past the
+ * nk_context, as only pntr_nuklear points the command buffer's allocator back at the context.
+ *
+ * @return The state, or NULL when the context wasn't created by pntr_nuklear.
+ *
+ * @internal
+ */
+static inline pntr_nuklear_context* pntr_nuklear_get_context(struct nk_context* ctx) {
+    return (ctx->memory.pool.userdata.ptr == (void*)ctx) ? (pntr_nuklear_context*)ctx : NULL;
+}
+
+/**
+ * Measures the given text with pntr_measure_text_ex(), remembering the width of short text across frames.
+ *
+ * @internal
+ */
+static float pntr_nuklear_measure_text(pntr_nuklear_font* nuklearFont, const char* text, int len) {
+    int textLen = 0;
+    while (textLen < len && text[textLen] != '\0') {
+        textLen++;
+    }
+    if (textLen == 0) {
+        return 0.0f;
+    }
+    if (textLen > PNTR_NUKLEAR_TEXT_CACHE_MAX_LEN) {
+        return (float)pntr_measure_text_ex(nuklearFont->font, text, textLen).x;
+    }
+
+    uint64_t hash = pntr_nuklear_hash(PNTR_NUKLEAR_HASH_SEED, text, (nk_size)textLen);
+    pntr_nuklear_text_cache_entry* entry = &nuklearFont->cache[hash & (PNTR_NUKLEAR_TEXT_CACHE_SIZE - 1)];
+    if (entry->len == textLen && entry->font == nuklearFont->font) {
+        int i = 0;
+        while (i < textLen && entry->text[i] == text[i]) {
+            i++;
+        }
+        if (i == textLen) {
+            nuklearFont->cacheHits++;
+            return entry->width;
+        }
+    }
+
+    nuklearFont->cacheMisses++;
+    entry->font = nuklearFont->font;
+    entry->len = textLen;
+    entry->width = (float)pntr_measure_text_ex(nuklearFont->font, text, textLen).x;
+    PNTR_MEMCPY(entry->text, text, (size_t)textLen);
+    return entry->width;
+}
+
+/**
+ * Nuklear callback to calculate the width of the given text.
+ *
+ * @internal
+ * @private
+ */
+static float _pntr_nuklear_text_width(nk_handle font, float height, const char* text, int len) {
+    NK_UNUSED(height);
+    pntr_nuklear_font* nuklearFont = (pntr_nuklear_font*)font.ptr;
+    if (!nuklearFont->additive) {
+        return pntr_nuklear_measure_text(nuklearFont, text, len);
+    }
+
+    // Sum the advances, keeping the widest line like pntr_measure_text_ex() does.
+    int width = 0;
+    int lineWidth = 0;
+    for (int i = 0; i < len && text[i] != '\0'; i++) {
+        unsigned char character = (unsigned char)text[i];
+        if (character >= 128) {
+            return pntr_nuklear_measure_text(nuklearFont, text, len);
+        }
+
+        if (character == '\n') {
+            lineWidth = 0;
+            continue;
+        }
+
+        lineWidth += nuklearFont->advances[character];
+        if (lineWidth > width) {
+            width = lineWidth;
+        }
+    }
+
+    return (float)width;
+}
+
+/**
+ * Sets up the given Nuklear font for a pntr_font, measuring the advance of each ASCII character.
+ *
+ * @internal
+ */
+static void pntr_nuklear_font_init(pntr_nuklear_font* nuklearFont, pntr_font* font) {
+    PNTR_MEMSET(nuklearFont, 0, sizeof(pntr_nuklear_font));
+    nuklearFont->font = font;
+
+    // Find the tallest character.
+    #define PNTR_LOAD_NUKLEAR_ALPHABET_START (33)
+    #define PNTR_LOAD_NUKLEAR_ALPHABET_LEN (172 - PNTR_LOAD_NUKLEAR_ALPHABET_START)
+    char theAlphabet[PNTR_LOAD_NUKLEAR_ALPHABET_LEN + 1];
+    for (int i = 0; i < PNTR_LOAD_NUKLEAR_ALPHABET_LEN; i++) {
+        theAlphabet[i] = (char)(i + PNTR_LOAD_NUKLEAR_ALPHABET_START);
+    }
+    theAlphabet[PNTR_LOAD_NUKLEAR_ALPHABET_LEN] = '\0';
+    pntr_vector size = pntr_measure_text_ex(font, theAlphabet, PNTR_LOAD_NUKLEAR_ALPHABET_LEN);
+
+    // Measure each printable character on its own.
+    char printable[128];
+    int printableLen = 0;
+    int sum = 0;
+    for (int i = 1; i < 128; i++) {
+        char character[2] = { (char)i, '\0' };
+        nuklearFont->advances[i] = (i == '\n') ? 0 : pntr_measure_text_ex(font, character, 1).x;
+        if (i >= 32 && i < 127) {
+            printable[printableLen++] = (char)i;
+            sum += nuklearFont->advances[i];
+        }
+    }
+    printable[printableLen] = '\0';
+
+    // Only trust the advances when they add up to the measured width, which kerning would break.
+    nuklearFont->additive = pntr_measure_text_ex(font, printable, printableLen).x == sum;
+
+    nuklearFont->userFont.height = (float)size.y;
+    nuklearFont->userFont.width = _pntr_nuklear_text_width;
+    nuklearFont->userFont.userdata.ptr = nuklearFont;
+
+    // Map each character to its glyph, keeping the first like pntr_draw_text() does.
+    for (int i = 0; i < 256; i++) {
+        nuklearFont->glyphs[i] = -1;
+    }
+    for (int i = font->charactersLen - 1; i >= 0; i--) {
+        nuklearFont->glyphs[(unsigned char)font->characters[i]] = i;
+    }
+
+    // Keep the atlas as 8-bit coverage, which is only possible when its glyphs are white.
+    pntr_image* atlas = font->atlas;
+    if (atlas == NULL) {
+        return;
+    }
+    for (int y = 0; y < atlas->height; y++) {
+        const pntr_color* row = (const pntr_color*)((const unsigned char*)atlas->data + y * atlas->pitch);
+        for (int x = 0; x < atlas->width; x++) {
+            if (row[x].rgba.a > 0 && (row[x].rgba.r != 255 || row[x].rgba.g != 255 || row[x].rgba.b != 255)) {
+                return;
+            }
+        }
+    }
+
+    nuklearFont->coverage = (unsigned char*)pntr_load_memory((size_t)(atlas->width * atlas->height));
+    if (nuklearFont->coverage == NULL) {
+        return;
+    }
+    for (int y = 0; y < atlas->height; y++) {
+        const pntr_color* row = (const pntr_color*)((const unsigned char*)atlas->data + y * atlas->pitch);
+        for (int x = 0; x < atlas->width; x++) {
+            nuklearFont->coverage[y * atlas->width + x] = row[x].rgba.a;
+        }
+    }
+}
+
+/**
+ * Unloads what pntr_nuklear_font_init() allocated.
+ *
+ * @internal
+ */
+static void pntr_nuklear_font_unload(pntr_nuklear_font* nuklearFont) {
+    pntr_unload_memory(nuklearFont->coverage);
+    nuklearFont->coverage = NULL;
+}
+
+/**
+ * Empties the cache of rescaled images.
+ *
+ * @internal
+ */
+static void pntr_nuklear_clear_image_cache(pntr_nuklear_context* state) {
+    for (int i = 0; i < state->imageCacheCount; i++) {
+        pntr_unload_image(state->imageCache[i].scaled);
+    }
+    state->imageCacheCount = 0;
+
+    for (int i = 0; i < state->mipmapCount; i++) {
+        for (int level = 1; level < PNTR_NUKLEAR_MAX_MIP_LEVELS; level++) {
+            pntr_unload_image(state->mipmaps[i].levels[level]);
+        }
+    }
+    state->mipmapCount = 0;
+}
+
+/**
+ * Removes the rescaled copies and mipmap of an image from the image cache.
+ *
+ * @internal
+ */
+static void pntr_nuklear_uncache_image(pntr_nuklear_context* state, pntr_image* image) {
+    for (int i = state->imageCacheCount - 1; i >= 0; i--) {
+        if (state->imageCache[i].source == image) {
+            pntr_unload_image(state->imageCache[i].scaled);
+            state->imageCache[i] = state->imageCache[--state->imageCacheCount];
+        }
+    }
+
+    for (int i = state->mipmapCount - 1; i >= 0; i--) {
+        if (state->mipmaps[i].source == image) {
+            for (int level = 1; level < PNTR_NUKLEAR_MAX_MIP_LEVELS; level++) {
+                pntr_unload_image(state->mipmaps[i].levels[level]);
+            }
+            state->mipmaps[i] = state->mipmaps[--state->mipmapCount];
+        }
+    }
+}
+
+/**
+ * Starts a new frame of the image cache.
+ *
+ * Images beyond the cache's size are kept for as long as each frame draws them, so that frames drawing the same
+ * images don't replace one another's. Those the last frame didn't draw are let go of, oldest first.
+ *
+ * @internal
+ */
+static void pntr_nuklear_trim_image_cache(pntr_nuklear_context* state) {
+    while (state->imageCacheCount > PNTR_NUKLEAR_IMAGE_CACHE_SIZE) {
+        int oldest = -1;
+        for (int i = 0; i < state->imageCacheCount; i++) {
+            if (state->imageCache[i].lastUsed <= state->imageCacheFrame && (oldest < 0 || state->imageCache[i].lastUsed < state->imageCache[oldest].lastUsed)) {
+                oldest = i;
+            }
+        }
+        if (oldest < 0) {
+            break;
+        }
+        pntr_unload_image(state->imageCache[oldest].scaled);
+        state->imageCache[oldest] = state->imageCache[--state->imageCacheCount];
+    }
+
+    while (state->mipmapCount > PNTR_NUKLEAR_MIPMAP_CACHE_SIZE) {
+        int oldest = -1;
+        for (int i = 0; i < state->mipmapCount; i++) {
+            if (state->mipmaps[i].lastUsed <= state->imageCacheFrame && (oldest < 0 || state->mipmaps[i].lastUsed < state->mipmaps[oldest].lastUsed)) {
+                oldest = i;
+            }
+        }
+        if (oldest < 0) {
+            break;
+        }
+        for (int level = 1; level < PNTR_NUKLEAR_MAX_MIP_LEVELS; level++) {
+            pntr_unload_image(state->mipmaps[oldest].levels[level]);
+        }
+        state->mipmaps[oldest] = state->mipmaps[--state->mipmapCount];
+    }
+
+    state->imageCacheFrame = state->imageCacheClock;
+}
+
+/**
+ * Retrieve the pntr_font used by the given Nuklear font.
+ *
+ * @internal
+ */
+static inline pntr_font* pntr_nuklear_get_font(const struct nk_user_font* font) {
+    if (font->width == _pntr_nuklear_text_width) {
+        return ((pntr_nuklear_font*)font->userdata.ptr)->font;
+    }
+
+    // A user-provided Nuklear font, holding the pntr_font directly.
+    return (pntr_font*)font->userdata.ptr;
+}
+
+/**
+ * Draws the given text command by blitting glyphs from the font's coverage atlas.
+ *
+ * Falls back to pntr_draw_text() for fonts without a coverage atlas, and for text with line breaks or non-ASCII
+ * characters.
+ *
+ * @internal
+ */
+static void pntr_nuklear_draw_text(pntr_image* dst, const struct nk_command_text* text) {
+    pntr_color foreground = pntr_nk_color_to_color(text->foreground);
+    pntr_nuklear_font* nuklearFont = (text->font->width == _pntr_nuklear_text_width) ? (pntr_nuklear_font*)text->font->userdata.ptr : NULL;
+    bool blit = nuklearFont != NULL && nuklearFont->coverage != NULL;
+    for (int i = 0; blit && i < text->length && text->string[i] != '\0'; i++) {
+        unsigned char character = (unsigned char)text->string[i];
+        blit = character != '\n' && character < 128;
+    }
+    if (!blit) {
+        pntr_draw_text(dst, pntr_nuklear_get_font(text->font), (const char*)text->string, text->x, text->y, foreground);
+        return;
+    }
+    if (foreground.rgba.a == 0) {
+        return;
+    }
+
+    // Tint each coverage value once, the same way pntr_draw_image_tint_rec() does.
+    pntr_color tinted[256];
+    unsigned char tintedReady[256];
+    PNTR_MEMSET(tintedReady, 0, sizeof(tintedReady));
+
+    pntr_font* font = nuklearFont->font;
+    int atlasWidth = font->atlas->width;
+    pntr_rectangle clip = pntr_nuklear_rect_intersect(dst->clip, PNTR_CLITERAL(pntr_rectangle) { 0, 0, dst->width, dst->height });
+    int x = text->x;
+    for (int i = 0; i < text->length && text->string[i] != '\0'; i++) {
+        int index = nuklearFont->glyphs[(unsigned char)text->string[i]];
+        if (index < 0) {
+            continue;
+        }
+
+        pntr_rectangle src = font->srcRects[index];
+        pntr_rectangle glyph = font->glyphRects[index];
+        int glyphX = x + glyph.x;
+        int glyphY = text->y + glyph.y;
+        x += glyph.x + glyph.width;
+        pntr_rectangle area = pntr_nuklear_rect_intersect(PNTR_CLITERAL(pntr_rectangle) { glyphX, glyphY, src.width, src.height }, clip);
+        if (pntr_nuklear_rect_empty(area)) {
+            continue;
+        }
+
+        int srcX = src.x + area.x - glyphX;
+        int srcY = src.y + area.y - glyphY;
+        for (int row = 0; row < area.height; row++) {
+            const unsigned char* coverage = nuklearFont->coverage + (srcY + row) * atlasWidth + srcX;
+            pntr_color* pixel = (pntr_color*)((unsigned char*)dst->data + (area.y + row) * dst->pitch) + area.x;
+            for (int column = 0; column < area.width; column++) {
+                unsigned char alpha = coverage[column];
+                if (alpha == 0) {
+                    continue;
+                }
+                if (!tintedReady[alpha]) {
+                    tinted[alpha] = pntr_color_tint(pntr_new_color(255, 255, 255, alpha), foreground);
+                    tintedReady[alpha] = 1;
+                }
+                pntr_blend_color(pixel + column, tinted[alpha]);
+            }
+        }
+    }
+}
+
+static void* pntr_nuklear_alloc(nk_handle handle, void *old, nk_size size) {
+    NK_UNUSED(handle);
+    NK_UNUSED(old);
+    return pntr_load_memory((size_t)size);
+}
+
+static void pntr_nuklear_free(nk_handle handle, void *old) {
+    NK_UNUSED(handle);
+    if (old != NULL) {
+        pntr_unload_memory(old);
+        (void)nk_inv_sqrt;
+    }
+}
+
+/**
+ * Replaces Nuklear's empty command buffer with one of the given size.
+ *
+ * @internal
+ */
+static void pntr_nuklear_resize_memory(struct nk_context* ctx, nk_size size) {
+    struct nk_buffer* memory = &ctx->memory;
+    if (memory->type != NK_BUFFER_DYNAMIC || memory->allocated != 0 || memory->memory.size == size) {
+        return;
+    }
+
+    void* buffer = memory->pool.alloc(memory->pool.userdata, memory->memory.ptr, size);
+    if (buffer == NULL) {
+        return;
+    }
+    if (memory->memory.ptr != NULL && memory->memory.ptr != buffer) {
+        memory->pool.free(memory->pool.userdata, memory->memory.ptr);
+    }
+    memory->memory.ptr = buffer;
+    memory->memory.size = size;
+    memory->size = size;
+}
+
+/**
+ * The size of an allocation, kept in front of the memory handed to Nuklear.
+ *
+ * @internal
+ */
+typedef union pntr_nuklear_allocation_header {
+    nk_size size;
+    double alignment;
+    void* pointer;
+} pntr_nuklear_allocation_header;
+
+/**
+ * Nuklear callback; Allocates memory with the context's allocator, counting what is allocated.
+ *
+ * @internal
+ */
+static void* pntr_nuklear_tracked_alloc(nk_handle handle, void* old, nk_size size) {
+    NK_UNUSED(old);
+    pntr_nuklear_context* state = (pntr_nuklear_context*)handle.ptr;
+    const struct nk_allocator* allocator = &state->allocator.allocator;
+    pntr_nuklear_allocation_header* header = (pntr_nuklear_allocation_header*)allocator->alloc(allocator->userdata, NULL, sizeof(pntr_nuklear_allocation_header) + size);
+    if (header == NULL) {
+        return NULL;
+    }
+
+    header->size = size;
+    pntr_nuklear_memory_stats* stats = &state->memoryStats;
+    stats->allocations++;
+    stats->liveBytes += size;
+    stats->peakBytes = PNTR_NUKLEAR_MAX(stats->peakBytes, stats->liveBytes);
+    return header + 1;
+}
+
+/**
+ * Nuklear callback; Frees memory allocated by pntr_nuklear_tracked_alloc().
+ *
+ * @internal
+ */
+static void pntr_nuklear_tracked_free(nk_handle handle, void* old) {
+    if (old == NULL) {
+        return;
+    }
+
+    pntr_nuklear_context* state = (pntr_nuklear_context*)handle.ptr;
+    pntr_nuklear_allocation_header* header = (pntr_nuklear_allocation_header*)old - 1;
+    state->memoryStats.frees++;
+    state->memoryStats.liveBytes -= header->size;
+    state->allocator.allocator.free(state->allocator.allocator.userdata, header);
+}
+
+#ifndef PNTR_NUKLEAR_DOUBLE_CLICK_TIME
+#define PNTR_NUKLEAR_DOUBLE_CLICK_TIME 0.3f
+#endif
+
+/**
+ * Retrieves the timer of seconds since the left mouse button was last pressed.
+ *
+ * Contexts without state share one timer.
+ *
+ * @internal
+ */
+static inline float* pntr_nuklear_double_click_timer(struct nk_context* ctx) {
+    static float sharedDoubleClickTimer = 1.0f;
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    return (state != NULL) ? &state->doubleClickTimer : &sharedDoubleClickTimer;
+}
+
+/**
+ * Tells Nuklear about a double click when the left mouse button is pressed soon enough after the last press.
+ *
+ * @param pressed Whether the left mouse button went down since the last call.
+ * @param down Whether the left mouse button is held down.
+ *
+ * @internal
+ */
+static inline void pntr_nuklear_double_click(struct nk_context* ctx, bool pressed, bool down, int x, int y) {
+    float* doubleClickTimer = pntr_nuklear_double_click_timer(ctx);
+    if (pressed) {
+        if (*doubleClickTimer < PNTR_NUKLEAR_DOUBLE_CLICK_TIME) {
+            nk_input_button(ctx, NK_BUTTON_DOUBLE, x, y, nk_true);
+            *doubleClickTimer = 1.0f;
+        }
+        else {
+            *doubleClickTimer = 0.0f;
+        }
+    }
+    if (!down) {
+        nk_input_button(ctx, NK_BUTTON_DOUBLE, x, y, nk_false);
+    }
+}
+
+#ifdef PNTR_APP_API
+/**
+ * Nuklear callback; Paste the current clipboard.
+ *
+ * @internal
+ */
+static void
+pntr_nuklear_clipboard_paste(nk_handle usr, struct nk_text_edit *edit)
+{
+    const char* text = pntr_app_clipboard((pntr_app*)usr.ptr);
+    if (text != NULL) {
+        nk_textedit_paste(edit, text, PNTR_STRLEN(text));
+    }
+}
+
+/**
+ * Nuklear callback; Copy the given text.
+ *
+ * @internal
+ */
+static void
+pntr_nuklear_clipboard_copy(nk_handle usr, const char *text, int len)
+{
+    pntr_app_set_clipboard((pntr_app*)usr.ptr, text, len);
+}
+
+/**
+ * Points the context's clipboard at the given pntr_app, which may change between calls.
+ *
+ * Clipboard handlers set by the application are left as they are.
+ *
+ * @internal
+ */
+static void pntr_nuklear_set_app(struct nk_context* ctx, pntr_app* app) {
+    bool copyUnset = ctx->clip.copy == NULL || ctx->clip.copy == pntr_nuklear_clipboard_copy;
+    bool pasteUnset = ctx->clip.paste == NULL || ctx->clip.paste == pntr_nuklear_clipboard_paste;
+    if (!copyUnset || !pasteUnset) {
+        return;
+    }
+
+    ctx->clip.userdata.ptr = app;
+    ctx->clip.copy = pntr_nuklear_clipboard_copy;
+    ctx->clip.paste = pntr_nuklear_clipboard_paste;
+}
+
+/**
+ * Fallback translation from a pntr_app key press to a printable character, assuming a US QWERTY layout.
+ *
+ * Override `PNTR_NUKLEAR_KEY_CHAR(app, key, shift)` before including pntr_nuklear.h to
+ * delegate to a layout-aware platform API (AZERTY, QWERTZ, Dvorak, etc.).
+ * Returns 0 when the key does not produce a printable character.
+ *
+ * @internal
+ */
+static char pntr_nuklear_default_key_char(pntr_app_key key, bool shift) {
+    if (key >= PNTR_APP_KEY_A && key <= PNTR_APP_KEY_Z) {
+        return shift ? (char)key : (char)(key + 32);
+    }
+    if (key >= PNTR_APP_KEY_KP_0 && key <= PNTR_APP_KEY_KP_9) {
+        return (char)(key - PNTR_APP_KEY_KP_0 + '0');
+    }
+    switch (key) {
+        case PNTR_APP_KEY_SPACE:         return ' ';
+        case PNTR_APP_KEY_APOSTROPHE:    return shift ? '"' : '\'';
+        case PNTR_APP_KEY_COMMA:         return shift ? '<' : ',';
+        case PNTR_APP_KEY_MINUS:         return shift ? '_' : '-';
+        case PNTR_APP_KEY_PERIOD:        return shift ? '>' : '.';
+        case PNTR_APP_KEY_SLASH:         return shift ? '?' : '/';
+        case PNTR_APP_KEY_0:             return shift ? ')' : '0';
+        case PNTR_APP_KEY_1:             return shift ? '!' : '1';
         case PNTR_APP_KEY_2:             return shift ? '@' : '2';
         case PNTR_APP_KEY_3:             return shift ? '#' : '3';
         case PNTR_APP_KEY_4:             return shift ? '$' : '4';
@@ -258,431 +1559,3265 @@ static char pntr_nuklear_default_key_char(pntr_app_key key, bool shift) {
     }
 }
 
-#ifndef PNTR_NUKLEAR_KEY_CHAR
-#define PNTR_NUKLEAR_KEY_CHAR(app, key, shift) pntr_nuklear_default_key_char((key), (shift))
-#endif
+#ifndef PNTR_NUKLEAR_KEY_CHAR
+#define PNTR_NUKLEAR_KEY_CHAR(app, key, shift) pntr_nuklear_default_key_char((key), (shift))
+#endif
+
+/**
+ * The bits of pntr_nuklear_context's modifiers for each shift and control key.
+ *
+ * @internal
+ */
+#define PNTR_NUKLEAR_MODIFIER_SHIFT 0x3
+#define PNTR_NUKLEAR_MODIFIER_CONTROL 0xC
+
+/**
+ * Translates a pntr_app key to the modifier bit it holds down, or 0 when it isn't shift or control.
+ *
+ * @internal
+ */
+static unsigned int pntr_nuklear_modifier(pntr_app_key key) {
+    switch (key) {
+        case PNTR_APP_KEY_LEFT_SHIFT:    return 0x1;
+        case PNTR_APP_KEY_RIGHT_SHIFT:   return 0x2;
+        case PNTR_APP_KEY_LEFT_CONTROL:  return 0x4;
+        case PNTR_APP_KEY_RIGHT_CONTROL: return 0x8;
+        default:                         return 0;
+    }
+}
+
+/**
+ * Translates a pntr_app key to the Nuklear key it always stands for.
+ *
+ * @internal
+ */
+static enum nk_keys pntr_nuklear_nk_key(pntr_app_key key) {
+    switch (key) {
+        case PNTR_APP_KEY_LEFT_ALT:
+        case PNTR_APP_KEY_RIGHT_ALT:     return NK_KEY_ALT;
+        case PNTR_APP_KEY_LEFT_SHIFT:
+        case PNTR_APP_KEY_RIGHT_SHIFT:   return NK_KEY_SHIFT;
+        case PNTR_APP_KEY_LEFT_CONTROL:
+        case PNTR_APP_KEY_RIGHT_CONTROL: return NK_KEY_CTRL;
+        case PNTR_APP_KEY_DELETE:        return NK_KEY_DEL;
+        case PNTR_APP_KEY_ENTER:
+        case PNTR_APP_KEY_KP_ENTER:      return NK_KEY_ENTER;
+        case PNTR_APP_KEY_TAB:           return NK_KEY_TAB;
+        case PNTR_APP_KEY_BACKSPACE:     return NK_KEY_BACKSPACE;
+        case PNTR_APP_KEY_UP:            return NK_KEY_UP;
+        case PNTR_APP_KEY_DOWN:          return NK_KEY_DOWN;
+        case PNTR_APP_KEY_LEFT:          return NK_KEY_LEFT;
+        case PNTR_APP_KEY_RIGHT:         return NK_KEY_RIGHT;
+        case PNTR_APP_KEY_ESCAPE:        return NK_KEY_TEXT_RESET_MODE;
+        case PNTR_APP_KEY_PAGE_DOWN:     return NK_KEY_SCROLL_DOWN;
+        case PNTR_APP_KEY_PAGE_UP:       return NK_KEY_SCROLL_UP;
+        case PNTR_APP_KEY_F1:            return NK_KEY_F1;
+        case PNTR_APP_KEY_F2:            return NK_KEY_F2;
+        case PNTR_APP_KEY_F3:            return NK_KEY_F3;
+        case PNTR_APP_KEY_F4:            return NK_KEY_F4;
+        case PNTR_APP_KEY_F5:            return NK_KEY_F5;
+        case PNTR_APP_KEY_F6:            return NK_KEY_F6;
+        case PNTR_APP_KEY_F7:            return NK_KEY_F7;
+        case PNTR_APP_KEY_F8:            return NK_KEY_F8;
+        case PNTR_APP_KEY_F9:            return NK_KEY_F9;
+        case PNTR_APP_KEY_F10:           return NK_KEY_F10;
+        case PNTR_APP_KEY_F11:           return NK_KEY_F11;
+        case PNTR_APP_KEY_F12:           return NK_KEY_F12;
+        default:                         return NK_KEY_NONE;
+    }
+}
+
+/**
+ * Translates a pntr_app key to the Nuklear editing key it also stands for, depending on whether control is held.
+ *
+ * @internal
+ */
+static enum nk_keys pntr_nuklear_nk_text_key(pntr_app_key key, bool control) {
+    if (!control) {
+        switch (key) {
+            case PNTR_APP_KEY_HOME:      return NK_KEY_TEXT_LINE_START;
+            case PNTR_APP_KEY_END:       return NK_KEY_TEXT_LINE_END;
+            default:                     return NK_KEY_NONE;
+        }
+    }
+
+    switch (key) {
+        case PNTR_APP_KEY_C:             return NK_KEY_COPY;
+        case PNTR_APP_KEY_X:             return NK_KEY_CUT;
+        case PNTR_APP_KEY_V:             return NK_KEY_PASTE;
+        case PNTR_APP_KEY_HOME:          return NK_KEY_TEXT_START;
+        case PNTR_APP_KEY_END:           return NK_KEY_TEXT_END;
+        case PNTR_APP_KEY_Z:             return NK_KEY_TEXT_UNDO;
+        case PNTR_APP_KEY_Y:             return NK_KEY_TEXT_REDO;
+        case PNTR_APP_KEY_A:             return NK_KEY_TEXT_SELECT_ALL;
+        case PNTR_APP_KEY_LEFT:          return NK_KEY_TEXT_WORD_LEFT;
+        case PNTR_APP_KEY_RIGHT:         return NK_KEY_TEXT_WORD_RIGHT;
+        case PNTR_APP_KEY_PAGE_UP:       return NK_KEY_SCROLL_START;
+        case PNTR_APP_KEY_PAGE_DOWN:     return NK_KEY_SCROLL_END;
+        default:                         return NK_KEY_NONE;
+    }
+}
+
+/**
+ * Translates a pntr_app mouse button to a Nuklear button, or NK_BUTTON_MAX when Nuklear doesn't have it.
+ *
+ * @internal
+ */
+static enum nk_buttons pntr_nuklear_nk_button(pntr_app_mouse_button button) {
+    switch (button) {
+        case PNTR_APP_MOUSE_BUTTON_LEFT:   return NK_BUTTON_LEFT;
+        case PNTR_APP_MOUSE_BUTTON_MIDDLE: return NK_BUTTON_MIDDLE;
+        case PNTR_APP_MOUSE_BUTTON_RIGHT:  return NK_BUTTON_RIGHT;
+        case PNTR_APP_MOUSE_BUTTON_X1:     return NK_BUTTON_X1;
+        case PNTR_APP_MOUSE_BUTTON_X2:     return NK_BUTTON_X2;
+        default:                           return NK_BUTTON_MAX;
+    }
+}
+#endif
+
+/**
+ * A function run for each index of a batch of jobs, given the number of the worker thread running it.
+ *
+ * @internal
+ */
+typedef void (*pntr_nuklear_job)(void* data, int index, int worker);
+
+/**
+ * The share of a batch of jobs run by one thread.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_worker {
+    pntr_nuklear_job job;
+    void* data;
+    int id;
+    int first;
+    int count;
+    int stride;
+} pntr_nuklear_worker;
+
+static void pntr_nuklear_run_worker(pntr_nuklear_worker* worker) {
+    for (int i = worker->first; i < worker->count; i += worker->stride) {
+        worker->job(worker->data, i, worker->id);
+    }
+}
+
+#ifdef PNTR_NUKLEAR_ENABLE_THREADS
+/**
+ * Worker threads shared by every context, started the first time they're needed and kept until the last context
+ * is unloaded, so that frames don't pay for starting threads.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_pool {
+    pthread_mutex_t run;         // Held by the batch of jobs using the threads, and while starting or stopping them.
+    pthread_mutex_t mutex;       // Guards handing out the work.
+    pthread_cond_t wake;
+    pthread_cond_t done;
+    pthread_t threads[PNTR_NUKLEAR_MAX_THREADS];
+    int threadCount;             // Threads running, in slots 1 and up, as slot 0 is the calling thread's.
+    int users;                   // Contexts loaded, along with a batch of jobs in progress.
+    bool pending[PNTR_NUKLEAR_MAX_THREADS];
+    pntr_nuklear_worker* workers;
+    int running;
+    bool quit;
+} pntr_nuklear_pool;
+
+static pntr_nuklear_pool pntr_nuklear_threads = {
+    .run = PTHREAD_MUTEX_INITIALIZER,
+    .mutex = PTHREAD_MUTEX_INITIALIZER,
+    .wake = PTHREAD_COND_INITIALIZER,
+    .done = PTHREAD_COND_INITIALIZER
+};
+
+static void* pntr_nuklear_pool_thread(void* data) {
+    pntr_nuklear_pool* pool = &pntr_nuklear_threads;
+    int slot = *(int*)data;
+    pntr_unload_memory(data);
+
+    pthread_mutex_lock(&pool->mutex);
+    for (;;) {
+        while (!pool->quit && !pool->pending[slot]) {
+            pthread_cond_wait(&pool->wake, &pool->mutex);
+        }
+        if (!pool->pending[slot]) {
+            break;
+        }
+
+        pool->pending[slot] = false;
+        pntr_nuklear_worker* worker = &pool->workers[slot];
+        pthread_mutex_unlock(&pool->mutex);
+        pntr_nuklear_run_worker(worker);
+        pthread_mutex_lock(&pool->mutex);
+        if (--pool->running == 0) {
+            pthread_cond_signal(&pool->done);
+        }
+    }
+    pthread_mutex_unlock(&pool->mutex);
+    return NULL;
+}
+
+/**
+ * Starts threads until there are enough to fill the given number of slots, or one can't be started.
+ *
+ * Called with the run mutex held.
+ *
+ * @internal
+ */
+static void pntr_nuklear_pool_start(pntr_nuklear_pool* pool, int slots) {
+    while (pool->threadCount + 1 < slots) {
+        int* slot = (int*)pntr_load_memory(sizeof(int));
+        if (slot == NULL) {
+            return;
+        }
+        *slot = pool->threadCount + 1;
+        if (pthread_create(&pool->threads[*slot], NULL, pntr_nuklear_pool_thread, slot) != 0) {
+            pntr_unload_memory(slot);
+            return;
+        }
+        pool->threadCount++;
+    }
+}
+
+/**
+ * Stops the threads once nothing uses them anymore.
+ *
+ * Called with the run mutex held.
+ *
+ * @internal
+ */
+static void pntr_nuklear_pool_stop(pntr_nuklear_pool* pool) {
+    if (pool->users > 0 || pool->threadCount == 0) {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->mutex);
+    pool->quit = true;
+    pthread_cond_broadcast(&pool->wake);
+    pthread_mutex_unlock(&pool->mutex);
+    for (int i = 1; i <= pool->threadCount; i++) {
+        pthread_join(pool->threads[i], NULL);
+    }
+    pool->threadCount = 0;
+    pool->quit = false;
+}
+
+/**
+ * Stops the context's render thread, once it has drawn its last frame.
+ *
+ * @internal
+ */
+static void pntr_nuklear_stop_frame_thread(pntr_nuklear_context* state) {
+    if (!state->frameThreadStarted) {
+        return;
+    }
+
+    pthread_mutex_lock(&state->frameMutex);
+    state->frameQuit = true;
+    pthread_cond_signal(&state->frameWake);
+    pthread_mutex_unlock(&state->frameMutex);
+    pthread_join(state->frameThread, NULL);
+
+    pthread_cond_destroy(&state->frameDone);
+    pthread_cond_destroy(&state->frameWake);
+    pthread_mutex_destroy(&state->frameMutex);
+    state->frameThreadStarted = false;
+}
+#endif
+
+/**
+ * Keeps the worker threads around while a context is loaded.
+ *
+ * @internal
+ */
+static void pntr_nuklear_pool_acquire(void) {
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        pthread_mutex_lock(&pntr_nuklear_threads.run);
+        pntr_nuklear_threads.users++;
+        pthread_mutex_unlock(&pntr_nuklear_threads.run);
+    #endif
+}
+
+/**
+ * Lets go of the worker threads, stopping them when no context is loaded anymore.
+ *
+ * @internal
+ */
+static void pntr_nuklear_pool_release(void) {
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        pthread_mutex_lock(&pntr_nuklear_threads.run);
+        pntr_nuklear_threads.users--;
+        pntr_nuklear_pool_stop(&pntr_nuklear_threads);
+        pthread_mutex_unlock(&pntr_nuklear_threads.run);
+    #endif
+}
+
+/**
+ * Runs the job for each index from 0 to count, spread across the given number of threads.
+ *
+ * The calling thread takes a share of the work too, and the rest goes to the shared worker threads. While another
+ * batch of jobs is using them, or without PNTR_NUKLEAR_ENABLE_THREADS, everything runs on the calling thread.
+ *
+ * @internal
+ */
+static void pntr_nuklear_run_jobs(pntr_nuklear_job job, void* data, int count, int threads) {
+    threads = PNTR_NUKLEAR_MIN(PNTR_NUKLEAR_MIN(threads, count), PNTR_NUKLEAR_MAX_THREADS);
+    if (threads < 1) {
+        threads = 1;
+    }
+
+    pntr_nuklear_worker workers[PNTR_NUKLEAR_MAX_THREADS];
+    for (int i = 0; i < threads; i++) {
+        workers[i].job = job;
+        workers[i].data = data;
+        workers[i].id = i;
+        workers[i].first = i;
+        workers[i].count = count;
+        workers[i].stride = threads;
+    }
+
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        pntr_nuklear_pool* pool = &pntr_nuklear_threads;
+        if (threads > 1 && pthread_mutex_trylock(&pool->run) == 0) {
+            pool->users++;
+            pntr_nuklear_pool_start(pool, threads);
+            int started = PNTR_NUKLEAR_MIN(pool->threadCount + 1, threads);
+
+            // Hand a share to each thread, and take the first one here.
+            pthread_mutex_lock(&pool->mutex);
+            pool->workers = workers;
+            pool->running = started - 1;
+            for (int i = 1; i < started; i++) {
+                pool->pending[i] = true;
+            }
+            pthread_cond_broadcast(&pool->wake);
+            pthread_mutex_unlock(&pool->mutex);
+
+            pntr_nuklear_run_worker(&workers[0]);
+
+            // The shares of threads that couldn't be started are done here too.
+            for (int i = started; i < threads; i++) {
+                pntr_nuklear_run_worker(&workers[i]);
+            }
+
+            pthread_mutex_lock(&pool->mutex);
+            while (pool->running > 0) {
+                pthread_cond_wait(&pool->done, &pool->mutex);
+            }
+            pthread_mutex_unlock(&pool->mutex);
+
+            pool->users--;
+            pntr_nuklear_pool_stop(pool);
+            pthread_mutex_unlock(&pool->run);
+            return;
+        }
+    #endif
+
+    for (int i = 0; i < threads; i++) {
+        pntr_nuklear_run_worker(&workers[i]);
+    }
+}
+
+/**
+ * Creates the context, using the given block of memory for Nuklear when there is one.
+ *
+ * @internal
+ */
+static struct nk_context* pntr_nuklear_init(pntr_font* font, const pntr_nuklear_allocator* allocator, void* memory, nk_size size) {
+    if (font == NULL) {
+        return NULL;
+    }
+
+    // Build the memory.
+    pntr_nuklear_context* state = (pntr_nuklear_context*)pntr_load_memory(sizeof(pntr_nuklear_context));
+    if (state == NULL) {
+        return NULL;
+    }
+    PNTR_MEMSET(state, 0, sizeof(pntr_nuklear_context));
+    struct nk_context* ctx = &state->ctx;
+
+    // Allocator
+    if (allocator != NULL) {
+        state->allocator = *allocator;
+    }
+    if (state->allocator.allocator.alloc == NULL || state->allocator.allocator.free == NULL) {
+        state->allocator.allocator.alloc = pntr_nuklear_alloc;
+        state->allocator.allocator.free = pntr_nuklear_free;
+    }
+    if (state->allocator.historyFrames <= 0) {
+        state->allocator.historyFrames = PNTR_NUKLEAR_MEMORY_HISTORY;
+    }
+    state->allocator.historyFrames = PNTR_NUKLEAR_MIN(state->allocator.historyFrames, PNTR_NUKLEAR_MAX_MEMORY_HISTORY);
+    if (state->allocator.growStep == 0) {
+        state->allocator.growStep = PNTR_NUKLEAR_MEMORY_STEP;
+    }
+
+    // Set up the font.
+    pntr_nuklear_font_init(&state->font, font);
+    state->curveTolerance = PNTR_NUKLEAR_CURVE_TOLERANCE;
+    state->doubleClickTimer = 1.0f;
+
+    // Create the nuklear environment.
+    struct nk_allocator tracked;
+    tracked.userdata.ptr = state;
+    tracked.alloc = pntr_nuklear_tracked_alloc;
+    tracked.free = pntr_nuklear_tracked_free;
+    int result = (memory == NULL) ? nk_init(ctx, &tracked, &state->font.userFont) : nk_init_fixed(ctx, memory, size, &state->font.userFont);
+    if (result == 0) {
+        pntr_nuklear_font_unload(&state->font);
+        pntr_unload_memory(state);
+        return NULL;
+    }
+    if (memory == NULL) {
+        pntr_nuklear_resize_memory(ctx, state->allocator.growStep);
+    }
+
+    // A fixed command buffer never allocates, so its allocator only marks the context as having state.
+    ctx->memory.pool.userdata.ptr = state;
+
+    // Let Nuklear know that it may now process events.
+    nk_input_begin(ctx);
+    pntr_nuklear_pool_acquire();
+
+    return ctx;
+}
+
+PNTR_NUKLEAR_API struct nk_context* pntr_load_nuklear(pntr_font* font) {
+    return pntr_nuklear_init(font, NULL, NULL, 0);
+}
+
+PNTR_NUKLEAR_API struct nk_context* pntr_load_nuklear_ex(pntr_font* font, const pntr_nuklear_allocator* allocator) {
+    return pntr_nuklear_init(font, allocator, NULL, 0);
+}
+
+PNTR_NUKLEAR_API struct nk_context* pntr_load_nuklear_fixed(pntr_font* font, void* memory, nk_size size) {
+    if (memory == NULL || size == 0) {
+        return NULL;
+    }
+
+    return pntr_nuklear_init(font, NULL, memory, size);
+}
+
+PNTR_NUKLEAR_API void pntr_unload_nuklear(struct nk_context* ctx) {
+    // Skip unloading if it's not set, or if it belongs to whoever called nk_init.
+    pntr_nuklear_context* state = (ctx == NULL) ? NULL : pntr_nuklear_get_context(ctx);
+    if (state == NULL) {
+        return;
+    }
+
+    // Clear up anything remaining from the context.
+    pntr_nuklear_wait(ctx);
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        pntr_nuklear_stop_frame_thread(state);
+    #endif
+    nk_input_end(ctx);
+    nk_clear(ctx);
+
+    // The user font lives in the context state.
+    ctx->style.font = NULL;
+
+    // Unload the nuklear context.
+    nk_free(ctx);
+
+    // Unload the memory
+    pntr_nuklear_font_unload(&state->font);
+    for (int i = 0; i < PNTR_NUKLEAR_MAX_THREADS; i++) {
+        pntr_unload_memory(state->scratch[i].memory);
+    }
+    pntr_nuklear_clear_image_cache(state);
+    pntr_unload_memory(state->imageCache);
+    pntr_unload_memory(state->mipmaps);
+    pntr_unload_memory(state->items);
+    pntr_unload_memory(state->previous);
+    pntr_unload_memory(state->tileStart);
+    pntr_unload_memory(state->tileItems);
+    for (int i = 0; i < state->layerCount; i++) {
+        pntr_unload_image(state->layers[i].image);
+    }
+    pntr_unload_memory(state->layers);
+    pntr_unload_memory(state->layerCommands);
+    pntr_unload_memory(state->frameCommands);
+    pntr_unload_memory(state);
+
+    pntr_nuklear_pool_release();
+}
+
+PNTR_NUKLEAR_API void pntr_nuklear_update(struct nk_context* ctx, PNTR_APP_TYPE* app) {
+    if (ctx == NULL || app == NULL) {
+        return;
+    }
+
+    #ifndef PNTR_APP_API
+        return;
+    #else
+        pntr_nuklear_set_app(ctx, app);
+
+        // Delta Time
+        ctx->delta_time_seconds = pntr_app_delta_time(app);
+        *pntr_nuklear_double_click_timer(ctx) += ctx->delta_time_seconds;
+        pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+
+        // Input already came through pntr_nuklear_event().
+        if (state != NULL && state->eventDriven) {
+            return;
+        }
+
+        // Keyboard
+        bool shift = pntr_app_key_down(app, PNTR_APP_KEY_LEFT_SHIFT) || pntr_app_key_down(app, PNTR_APP_KEY_RIGHT_SHIFT);
+        bool control = pntr_app_key_down(app, PNTR_APP_KEY_LEFT_CONTROL) || pntr_app_key_down(app, PNTR_APP_KEY_RIGHT_CONTROL);
+        nk_input_key(ctx, NK_KEY_ALT, pntr_app_key_down(app, PNTR_APP_KEY_LEFT_ALT) || pntr_app_key_down(app, PNTR_APP_KEY_RIGHT_ALT));
+        nk_input_key(ctx, NK_KEY_SHIFT, shift);
+        nk_input_key(ctx, NK_KEY_CTRL, control);
+        nk_input_key(ctx, NK_KEY_DEL, pntr_app_key_down(app, PNTR_APP_KEY_DELETE));
+        nk_input_key(ctx, NK_KEY_ENTER, pntr_app_key_down(app, PNTR_APP_KEY_ENTER) || pntr_app_key_down(app, PNTR_APP_KEY_KP_ENTER));
+        nk_input_key(ctx, NK_KEY_TAB, pntr_app_key_down(app, PNTR_APP_KEY_TAB));
+        nk_input_key(ctx, NK_KEY_BACKSPACE, pntr_app_key_down(app, PNTR_APP_KEY_BACKSPACE));
+        nk_input_key(ctx, NK_KEY_COPY, control && pntr_app_key_pressed(app, PNTR_APP_KEY_C));
+        nk_input_key(ctx, NK_KEY_CUT, control && pntr_app_key_pressed(app, PNTR_APP_KEY_X));
+        nk_input_key(ctx, NK_KEY_PASTE, control && pntr_app_key_pressed(app, PNTR_APP_KEY_V));
+        nk_input_key(ctx, NK_KEY_UP, pntr_app_key_down(app, PNTR_APP_KEY_UP));
+        nk_input_key(ctx, NK_KEY_DOWN, pntr_app_key_down(app, PNTR_APP_KEY_DOWN));
+        nk_input_key(ctx, NK_KEY_LEFT, pntr_app_key_down(app, PNTR_APP_KEY_LEFT));
+        nk_input_key(ctx, NK_KEY_RIGHT, pntr_app_key_down(app, PNTR_APP_KEY_RIGHT));
+        //nk_input_key(ctx, NK_KEY_TEXT_INSERT_MODE, pntr_app_key_down(app, PNTR_APP_KEY_ENTER));
+        //nk_input_key(ctx, NK_KEY_TEXT_REPLACE_MODE, pntr_app_key_down(app, PNTR_APP_KEY_ESCAPE));
+        nk_input_key(ctx, NK_KEY_TEXT_RESET_MODE, pntr_app_key_down(app, PNTR_APP_KEY_ESCAPE));
+        nk_input_key(ctx, NK_KEY_TEXT_LINE_START, !control && pntr_app_key_down(app, PNTR_APP_KEY_HOME));
+        nk_input_key(ctx, NK_KEY_TEXT_LINE_END, !control && pntr_app_key_down(app, PNTR_APP_KEY_END));
+        nk_input_key(ctx, NK_KEY_TEXT_START, control && pntr_app_key_down(app, PNTR_APP_KEY_HOME));
+        nk_input_key(ctx, NK_KEY_TEXT_END, control && pntr_app_key_down(app, PNTR_APP_KEY_END));
+        nk_input_key(ctx, NK_KEY_TEXT_UNDO, control && pntr_app_key_down(app, PNTR_APP_KEY_Z));
+        nk_input_key(ctx, NK_KEY_TEXT_REDO, control && pntr_app_key_down(app, PNTR_APP_KEY_Y));
+        nk_input_key(ctx, NK_KEY_TEXT_SELECT_ALL, control && pntr_app_key_down(app, PNTR_APP_KEY_A));
+        nk_input_key(ctx, NK_KEY_TEXT_WORD_LEFT, control && pntr_app_key_down(app, PNTR_APP_KEY_LEFT));
+        nk_input_key(ctx, NK_KEY_TEXT_WORD_RIGHT, control && pntr_app_key_down(app, PNTR_APP_KEY_RIGHT));
+        nk_input_key(ctx, NK_KEY_SCROLL_START, control && pntr_app_key_down(app, PNTR_APP_KEY_PAGE_UP));
+        nk_input_key(ctx, NK_KEY_SCROLL_END, control && pntr_app_key_down(app, PNTR_APP_KEY_PAGE_DOWN));
+        nk_input_key(ctx, NK_KEY_SCROLL_DOWN, pntr_app_key_down(app, PNTR_APP_KEY_PAGE_DOWN));
+        nk_input_key(ctx, NK_KEY_SCROLL_UP, pntr_app_key_down(app, PNTR_APP_KEY_PAGE_UP));
+
+        nk_input_key(ctx, NK_KEY_F1, pntr_app_key_down(app, PNTR_APP_KEY_F1));
+        nk_input_key(ctx, NK_KEY_F2, pntr_app_key_down(app, PNTR_APP_KEY_F2));
+        nk_input_key(ctx, NK_KEY_F3, pntr_app_key_down(app, PNTR_APP_KEY_F3));
+        nk_input_key(ctx, NK_KEY_F4, pntr_app_key_down(app, PNTR_APP_KEY_F4));
+        nk_input_key(ctx, NK_KEY_F5, pntr_app_key_down(app, PNTR_APP_KEY_F5));
+        nk_input_key(ctx, NK_KEY_F6, pntr_app_key_down(app, PNTR_APP_KEY_F6));
+        nk_input_key(ctx, NK_KEY_F7, pntr_app_key_down(app, PNTR_APP_KEY_F7));
+        nk_input_key(ctx, NK_KEY_F8, pntr_app_key_down(app, PNTR_APP_KEY_F8));
+        nk_input_key(ctx, NK_KEY_F9, pntr_app_key_down(app, PNTR_APP_KEY_F9));
+        nk_input_key(ctx, NK_KEY_F10, pntr_app_key_down(app, PNTR_APP_KEY_F10));
+        nk_input_key(ctx, NK_KEY_F11, pntr_app_key_down(app, PNTR_APP_KEY_F11));
+        nk_input_key(ctx, NK_KEY_F12, pntr_app_key_down(app, PNTR_APP_KEY_F12));
+
+        // Keyboard text input. Translation is layout-aware when
+        // PNTR_NUKLEAR_KEY_CHAR is overridden; otherwise falls back to US QWERTY.
+        if (!control) {
+            for (int k = PNTR_APP_KEY_FIRST; k < PNTR_APP_KEY_LAST; k++) {
+                if (pntr_app_key_pressed(app, (pntr_app_key)k)) {
+                    char c = PNTR_NUKLEAR_KEY_CHAR(app, (pntr_app_key)k, shift);
+                    if (c != 0) {
+                        nk_input_char(ctx, c);
+                    }
+                }
+            }
+        }
+
+        // Mouse
+        int mouseX = pntr_app_mouse_x(app);
+        int mouseY = pntr_app_mouse_y(app);
+        nk_input_motion(ctx, mouseX, mouseY);
+        nk_input_scroll(ctx, nk_vec2(0.0f, pntr_app_mouse_wheel(app)));
+        nk_input_button(ctx, NK_BUTTON_LEFT, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_LEFT));
+        nk_input_button(ctx, NK_BUTTON_MIDDLE, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_MIDDLE));
+        nk_input_button(ctx, NK_BUTTON_RIGHT, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_RIGHT));
+        nk_input_button(ctx, NK_BUTTON_X1, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_X1));
+        nk_input_button(ctx, NK_BUTTON_X2, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_X2));
+
+        // Double Click
+        pntr_nuklear_double_click(ctx, pntr_app_mouse_button_pressed(app, PNTR_APP_MOUSE_BUTTON_LEFT), pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_LEFT), mouseX, mouseY);
+    #endif
+}
+
+PNTR_NUKLEAR_API void pntr_nuklear_event(struct nk_context* ctx, PNTR_APP_TYPE* app, PNTR_APP_EVENT_TYPE* event) {
+    if (ctx == NULL || app == NULL || event == NULL) {
+        return;
+    }
+
+    #ifndef PNTR_APP_API
+        return;
+    #else
+        // The held modifiers are kept in the context's state.
+        pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+        if (state == NULL) {
+            return;
+        }
+
+        pntr_nuklear_set_app(ctx, app);
+        state->eventDriven = true;
+
+        switch (event->type) {
+            case PNTR_APP_EVENTTYPE_KEY_DOWN:
+            case PNTR_APP_EVENTTYPE_KEY_UP: {
+                bool down = event->type == PNTR_APP_EVENTTYPE_KEY_DOWN;
+                unsigned int modifier = pntr_nuklear_modifier(event->key);
+                state->modifiers = down ? (state->modifiers | modifier) : (state->modifiers & ~modifier);
+                bool shift = (state->modifiers & PNTR_NUKLEAR_MODIFIER_SHIFT) != 0;
+                bool control = (state->modifiers & PNTR_NUKLEAR_MODIFIER_CONTROL) != 0;
+
+                enum nk_keys key = pntr_nuklear_nk_key(event->key);
+                if (key != NK_KEY_NONE) {
+                    nk_input_key(ctx, key, down);
+                }
+
+                // Let go of the editing keys for both states of control, as it may have changed since the key went down.
+                if (down) {
+                    key = pntr_nuklear_nk_text_key(event->key, control);
+                    if (key != NK_KEY_NONE) {
+                        nk_input_key(ctx, key, nk_true);
+                    }
+                    if (!control) {
+                        char c = PNTR_NUKLEAR_KEY_CHAR(app, event->key, shift);
+                        if (c != 0) {
+                            nk_input_char(ctx, c);
+                        }
+                    }
+                }
+                else {
+                    key = pntr_nuklear_nk_text_key(event->key, false);
+                    if (key != NK_KEY_NONE) {
+                        nk_input_key(ctx, key, nk_false);
+                    }
+                    key = pntr_nuklear_nk_text_key(event->key, true);
+                    if (key != NK_KEY_NONE) {
+                        nk_input_key(ctx, key, nk_false);
+                    }
+                }
+            }
+            break;
+
+            case PNTR_APP_EVENTTYPE_MOUSE_MOVE:
+                nk_input_motion(ctx, event->mouseX, event->mouseY);
+            break;
+
+            case PNTR_APP_EVENTTYPE_MOUSE_BUTTON_DOWN:
+            case PNTR_APP_EVENTTYPE_MOUSE_BUTTON_UP: {
+                bool down = event->type == PNTR_APP_EVENTTYPE_MOUSE_BUTTON_DOWN;
+                enum nk_buttons button = pntr_nuklear_nk_button(event->mouseButton);
+                if (button == NK_BUTTON_MAX) {
+                    break;
+                }
+                nk_input_button(ctx, button, event->mouseX, event->mouseY, down);
+
+                // Double Click
+                if (button == NK_BUTTON_LEFT) {
+                    pntr_nuklear_double_click(ctx, down, down, event->mouseX, event->mouseY);
+                }
+            }
+            break;
+
+            case PNTR_APP_EVENTTYPE_MOUSE_WHEEL:
+                nk_input_scroll(ctx, nk_vec2(0.0f, (float)event->mouseWheel));
+            break;
+
+            default:
+            break;
+        }
+    #endif
+}
+
+/**
+ * Retrieves at least the given number of bytes of scratch memory, growing it when needed.
+ *
+ * @return The memory, valid until the next call, or NULL on failure.
+ *
+ * @internal
+ */
+static void* pntr_nuklear_scratch_get(pntr_nuklear_scratch* scratch, size_t size) {
+    if (size <= scratch->capacity) {
+        return scratch->memory;
+    }
+
+    size_t capacity = (scratch->capacity > 0) ? scratch->capacity : 1024;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+
+    void* memory = pntr_load_memory(capacity);
+    if (memory == NULL) {
+        return NULL;
+    }
+
+    pntr_unload_memory(scratch->memory);
+    scratch->memory = memory;
+    scratch->capacity = capacity;
+    return memory;
+}
+
+/**
+ * Converts Nuklear points to pntr vectors in the given scratch memory.
+ *
+ * @return The converted points, or NULL on failure.
+ *
+ * @internal
+ */
+static pntr_vector* pntr_nuklear_convert_points(pntr_nuklear_scratch* scratch, const struct nk_vec2i* points, int count) {
+    pntr_vector* output = (pntr_vector*)pntr_nuklear_scratch_get(scratch, sizeof(pntr_vector) * (size_t)count);
+    if (output == NULL) {
+        return NULL;
+    }
+
+    for (int i = 0; i < count; i++) {
+        output[i].x = points[i].x;
+        output[i].y = points[i].y;
+    }
+    return output;
+}
+
+/**
+ * The number of line segments needed to keep a flattened Bezier curve within the tolerance of the real curve.
+ *
+ * Uses Wang's formula, which bounds the distance from the curve by its second differences.
+ *
+ * @internal
+ */
+static int pntr_nuklear_curve_segments(const struct nk_command_curve* q, float tolerance) {
+    float x1 = (float)(q->begin.x - 2 * q->ctrl[0].x + q->ctrl[1].x);
+    float y1 = (float)(q->begin.y - 2 * q->ctrl[0].y + q->ctrl[1].y);
+    float x2 = (float)(q->ctrl[0].x - 2 * q->ctrl[1].x + q->end.x);
+    float y2 = (float)(q->ctrl[0].y - 2 * q->ctrl[1].y + q->end.y);
+    float length = PNTR_NUKLEAR_MAX(PNTR_SQRTF(x1 * x1 + y1 * y1), PNTR_SQRTF(x2 * x2 + y2 * y2));
+
+    int segments = (int)(PNTR_SQRTF(0.75f * length / tolerance) + 0.999f);
+    return PNTR_NUKLEAR_MIN(PNTR_NUKLEAR_MAX(segments, 1), PNTR_NUKLEAR_MAX_CURVE_SEGMENTS);
+}
+
+/**
+ * The number of line segments needed to keep a flattened arc within the tolerance of the real arc.
+ *
+ * A segment spanning the angle `a` strays `r * (1 - cos(a / 2))`, or about `r * a * a / 8`, from the arc.
+ *
+ * @internal
+ */
+static int pntr_nuklear_arc_segments(float radius, float startAngle, float endAngle, float tolerance) {
+    float sweep = endAngle - startAngle;
+    if (sweep < 0) {
+        sweep = -sweep;
+    }
+    if (radius <= tolerance) {
+        return 1;
+    }
+
+    float step = PNTR_SQRTF(8.0f * tolerance / radius);
+    int segments = (int)(sweep / step + 0.999f);
+    return PNTR_NUKLEAR_MIN(PNTR_NUKLEAR_MAX(segments, 1), PNTR_NUKLEAR_MAX_CURVE_SEGMENTS);
+}
+
+/**
+ * An edge of a polygon being filled by pntr_nuklear_fill_polygon().
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_edge {
+    float x;        // Where the edge crosses the current scanline's pixel centers.
+    float slope;    // How much x changes from one scanline to the next.
+    int top;        // The first scanline the edge crosses.
+    int bottom;     // The scanline after the last one the edge crosses.
+    int winding;    // 1 when the edge goes down, -1 when it goes up.
+} pntr_nuklear_edge;
+
+static inline int pntr_nuklear_ceil(float value) {
+    int truncated = (int)value;
+    return (value > (float)truncated) ? truncated + 1 : truncated;
+}
+
+/**
+ * Fills a polygon with an active edge table, writing clipped spans with pntr_nuklear_fill_span().
+ *
+ * Pixels are filled when their center is inside the polygon, using the even-odd rule, or the nonzero rule when
+ * PNTR_NUKLEAR_POLYGON_NONZERO is defined.
+ *
+ * Testing pixel centers means adjacent polygons never overlap or leave gaps. pntr_draw_polygon_fill() rounds the
+ * edge crossings its own way, so along slanted edges and at sharp corners the two may fill different boundary
+ * pixels, while the inside is the same.
+ *
+ * @return False when there wasn't enough scratch memory to fill the polygon.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_fill_polygon(pntr_image* dst, const struct nk_vec2i* points, int count, pntr_color color, pntr_nuklear_scratch* scratch) {
+    pntr_rectangle clip = pntr_nuklear_rect_intersect(dst->clip, PNTR_CLITERAL(pntr_rectangle) { 0, 0, dst->width, dst->height });
+    if (count < 3 || color.rgba.a == 0 || pntr_nuklear_rect_empty(clip)) {
+        return true;
+    }
+
+    pntr_nuklear_edge* edges = (pntr_nuklear_edge*)pntr_nuklear_scratch_get(scratch, (sizeof(pntr_nuklear_edge) + sizeof(int)) * (size_t)count);
+    if (edges == NULL) {
+        return false;
+    }
+    int* active = (int*)(void*)(edges + count);
+
+    // Build the edge table, leaving out the edges that cross no pixel centers.
+    int edgeCount = 0;
+    for (int i = 0; i < count; i++) {
+        struct nk_vec2i a = points[i];
+        struct nk_vec2i b = points[(i + 1) % count];
+        int winding = 1;
+        if (a.y > b.y) {
+            struct nk_vec2i swap = a;
+            a = b;
+            b = swap;
+            winding = -1;
+        }
+
+        pntr_nuklear_edge* edge = &edges[edgeCount];
+        edge->top = pntr_nuklear_ceil((float)a.y - 0.5f);
+        edge->bottom = pntr_nuklear_ceil((float)b.y - 0.5f);
+        if (edge->top >= edge->bottom) {
+            continue;
+        }
+        edge->slope = (float)(b.x - a.x) / (float)(b.y - a.y);
+        edge->x = (float)a.x + ((float)edge->top + 0.5f - (float)a.y) * edge->slope;
+        edge->winding = winding;
+        edgeCount++;
+    }
+
+    // Sort the edge table by the first scanline.
+    for (int gap = edgeCount / 2; gap > 0; gap /= 2) {
+        for (int i = gap; i < edgeCount; i++) {
+            pntr_nuklear_edge edge = edges[i];
+            int j = i;
+            for (; j >= gap && edges[j - gap].top > edge.top; j -= gap) {
+                edges[j] = edges[j - gap];
+            }
+            edges[j] = edge;
+        }
+    }
+
+    int next = 0;
+    int activeCount = 0;
+    int clipBottom = clip.y + clip.height;
+    int clipRight = clip.x + clip.width;
+    for (int y = (edgeCount > 0) ? PNTR_NUKLEAR_MAX(edges[0].top, clip.y) : clipBottom; y < clipBottom; y++) {
+        // Add the edges that start by this scanline, catching up on those that started above the clip.
+        while (next < edgeCount && edges[next].top <= y) {
+            edges[next].x += (float)(y - edges[next].top) * edges[next].slope;
+            active[activeCount++] = next++;
+        }
+
+        // Remove the edges that ended, keeping the rest sorted by x.
+        int kept = 0;
+        for (int i = 0; i < activeCount; i++) {
+            if (edges[active[i]].bottom > y) {
+                active[kept++] = active[i];
+            }
+        }
+        activeCount = kept;
+        if (activeCount == 0) {
+            if (next >= edgeCount) {
+                break;
+            }
+
+            // Skip ahead to where the next edge starts.
+            y = PNTR_NUKLEAR_MAX(y, edges[next].top - 1);
+            continue;
+        }
+        for (int i = 1; i < activeCount; i++) {
+            int index = active[i];
+            int j = i;
+            for (; j > 0 && edges[active[j - 1]].x > edges[index].x; j--) {
+                active[j] = active[j - 1];
+            }
+            active[j] = index;
+        }
+
+        // Fill the spans between the crossings.
+        pntr_color* row = dst->data + y * (dst->pitch >> 2);
+        int winding = 0;
+        for (int i = 0; i + 1 < activeCount; i++) {
+            #ifdef PNTR_NUKLEAR_POLYGON_NONZERO
+            winding += edges[active[i]].winding;
+            bool inside = winding != 0;
+            #else
+            winding ^= 1;
+            bool inside = winding != 0;
+            #endif
+            if (!inside) {
+                continue;
+            }
+
+            int left = PNTR_NUKLEAR_MAX(pntr_nuklear_ceil(edges[active[i]].x - 0.5f), clip.x);
+            int right = PNTR_NUKLEAR_MIN(pntr_nuklear_ceil(edges[active[i + 1]].x - 0.5f), clipRight);
+            if (left < right) {
+                pntr_nuklear_fill_span(row + left, right - left, color);
+            }
+        }
+
+        for (int i = 0; i < activeCount; i++) {
+            edges[active[i]].x += edges[active[i]].slope;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Scratch memory for pntr_nuklear_draw_polygon_fill(), which has no context to keep it in.
+ *
+ * It is shared by every call and kept for the next one, so polygons of any size are filled without allocating
+ * each time.
+ *
+ * @internal
+ */
+static pntr_nuklear_scratch pntr_nuklear_polygon_scratch = { NULL, 0 };
+#ifdef PNTR_NUKLEAR_ENABLE_THREADS
+static pthread_mutex_t pntr_nuklear_polygon_mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/**
+ * Draw a filled polygon using Nuklear values.
+ *
+ * Filled the same way as the polygon commands, with pntr_nuklear_fill_polygon().
+ *
+ * @see nk_rawfb_fill_polygon()
+ * @see https://github.com/Immediate-Mode-UI/Nuklear/blob/master/demo/rawfb/nuklear_rawfb.h
+ *
+ * @internal
+ */
+PNTR_NUKLEAR_API void pntr_nuklear_draw_polygon_fill(pntr_image* dst, const struct nk_vec2i *pnts, int count, pntr_color col) {
+    if (dst == NULL || pnts == NULL || count <= 0) return;
+
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        pthread_mutex_lock(&pntr_nuklear_polygon_mutex);
+    #endif
+    pntr_nuklear_fill_polygon(dst, pnts, count, col, &pntr_nuklear_polygon_scratch);
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        pthread_mutex_unlock(&pntr_nuklear_polygon_mutex);
+    #endif
+}
+
+/**
+ * Draws the region of an image at its own size, tinted.
+ *
+ * Opaque pixels are stored directly, and the rest are blended like pntr_draw_image_tint_rec() does.
+ *
+ * @internal
+ */
+static void pntr_nuklear_blit(pntr_image* dst, pntr_image* src, pntr_rectangle srcRect, int x, int y, pntr_color tint) {
+    pntr_rectangle area = pntr_nuklear_rect_intersect(PNTR_CLITERAL(pntr_rectangle) { x, y, srcRect.width, srcRect.height }, dst->clip);
+    area = pntr_nuklear_rect_intersect(area, PNTR_CLITERAL(pntr_rectangle) { 0, 0, dst->width, dst->height });
+    if (pntr_nuklear_rect_empty(area) || tint.rgba.a == 0) {
+        return;
+    }
+
+    bool tinted = tint.value != pntr_new_color(255, 255, 255, 255).value;
+    for (int row = area.y; row < area.y + area.height; row++) {
+        const pntr_color* srcRow = src->data + (srcRect.y + row - y) * (src->pitch >> 2) + srcRect.x;
+        pntr_color* dstRow = dst->data + row * (dst->pitch >> 2);
+        for (int column = area.x; column < area.x + area.width; column++) {
+            pntr_color color = srcRow[column - x];
+            if (tinted) {
+                color = pntr_color_tint(color, tint);
+            }
+            if (color.rgba.a == 255) {
+                dstRow[column] = color;
+            }
+            else if (color.rgba.a > 0) {
+                pntr_blend_color(dstRow + column, color);
+            }
+        }
+    }
+}
+
+/**
+ * Grows the given array to fit at least count elements, keeping its contents.
+ *
+ * @return The array to use, or NULL on failure, in which case the old array is still valid.
+ *
+ * @internal
+ */
+static void* pntr_nuklear_grow(void* buffer, int* capacity, int count, size_t elementSize) {
+    if (count <= *capacity) {
+        return buffer;
+    }
+
+    int newCapacity = (*capacity > 0) ? *capacity : 64;
+    while (newCapacity < count) {
+        newCapacity *= 2;
+    }
+
+    void* output = pntr_load_memory((size_t)newCapacity * elementSize);
+    if (output == NULL) {
+        return NULL;
+    }
+
+    if (buffer != NULL) {
+        PNTR_MEMCPY(output, buffer, (size_t)*capacity * elementSize);
+        pntr_unload_memory(buffer);
+    }
+
+    *capacity = newCapacity;
+    return output;
+}
+
+/**
+ * Makes a copy of the image at half its size, averaging each block of 2x2 pixels.
+ *
+ * @internal
+ */
+static pntr_image* pntr_nuklear_halve_image(pntr_image* image) {
+    int width = PNTR_NUKLEAR_MAX(image->width / 2, 1);
+    int height = PNTR_NUKLEAR_MAX(image->height / 2, 1);
+    pntr_image* output = pntr_new_image(width, height);
+    if (output == NULL) {
+        return NULL;
+    }
+
+    for (int y = 0; y < height; y++) {
+        const pntr_color* top = image->data + PNTR_NUKLEAR_MIN(y * 2, image->height - 1) * (image->pitch >> 2);
+        const pntr_color* bottom = image->data + PNTR_NUKLEAR_MIN(y * 2 + 1, image->height - 1) * (image->pitch >> 2);
+        pntr_color* row = output->data + y * (output->pitch >> 2);
+        for (int x = 0; x < width; x++) {
+            int left = PNTR_NUKLEAR_MIN(x * 2, image->width - 1);
+            int right = PNTR_NUKLEAR_MIN(x * 2 + 1, image->width - 1);
+            row[x] = pntr_new_color(
+                (unsigned char)((top[left].rgba.r + top[right].rgba.r + bottom[left].rgba.r + bottom[right].rgba.r + 2) / 4),
+                (unsigned char)((top[left].rgba.g + top[right].rgba.g + bottom[left].rgba.g + bottom[right].rgba.g + 2) / 4),
+                (unsigned char)((top[left].rgba.b + top[right].rgba.b + bottom[left].rgba.b + bottom[right].rgba.b + 2) / 4),
+                (unsigned char)((top[left].rgba.a + top[right].rgba.a + bottom[left].rgba.a + bottom[right].rgba.a + 2) / 4)
+            );
+        }
+    }
+
+    return output;
+}
+
+/**
+ * Finds the given level of an image's mipmap, making it when it isn't cached yet.
+ *
+ * @return The level, or NULL when it isn't cached and can't be made.
+ *
+ * @internal
+ */
+static pntr_image* pntr_nuklear_get_mip_level(pntr_nuklear_context* state, pntr_image* image, int level) {
+    pntr_nuklear_mipmap* mipmap = NULL;
+    int oldest = -1;
+    for (int i = 0; i < state->mipmapCount; i++) {
+        if (state->mipmaps[i].source == image && state->mipmaps[i].width == image->width && state->mipmaps[i].height == image->height) {
+            mipmap = &state->mipmaps[i];
+            break;
+        }
+        if (state->mipmaps[i].lastUsed <= state->imageCacheFrame && (oldest < 0 || state->mipmaps[i].lastUsed < state->mipmaps[oldest].lastUsed)) {
+            oldest = i;
+        }
+    }
+
+    // While tiles are drawn in parallel, only use what is already there.
+    if (state->imageCacheLocked) {
+        return (mipmap == NULL) ? NULL : mipmap->levels[level];
+    }
+
+    if (mipmap == NULL) {
+        // Grow rather than replace images this frame still draws.
+        if (state->mipmapCount < PNTR_NUKLEAR_MIPMAP_CACHE_SIZE || oldest < 0) {
+            pntr_nuklear_mipmap* mipmaps = (pntr_nuklear_mipmap*)pntr_nuklear_grow(state->mipmaps, &state->mipmapCapacity, state->mipmapCount + 1, sizeof(pntr_nuklear_mipmap));
+            if (mipmaps == NULL) {
+                return NULL;
+            }
+            state->mipmaps = mipmaps;
+            oldest = state->mipmapCount++;
+        }
+        else {
+            // Replace the least recently used image.
+            for (int i = 1; i < PNTR_NUKLEAR_MAX_MIP_LEVELS; i++) {
+                pntr_unload_image(state->mipmaps[oldest].levels[i]);
+            }
+        }
+
+        mipmap = &state->mipmaps[oldest];
+        PNTR_MEMSET(mipmap, 0, sizeof(pntr_nuklear_mipmap));
+        mipmap->source = image;
+        mipmap->width = image->width;
+        mipmap->height = image->height;
+    }
+    mipmap->lastUsed = ++state->imageCacheClock;
+    if (mipmap->levels[level] != NULL) {
+        return mipmap->levels[level];
+    }
+
+    // Halve the closest larger level, only keeping the one asked for.
+    int from = level - 1;
+    while (from > 0 && mipmap->levels[from] == NULL) {
+        from--;
+    }
+    pntr_image* current = (from == 0) ? image : mipmap->levels[from];
+    for (int i = from + 1; i <= level; i++) {
+        pntr_image* halved = pntr_nuklear_halve_image(current);
+        if (i > from + 1) {
+            pntr_unload_image(current);
+        }
+        if (halved == NULL) {
+            return NULL;
+        }
+        current = halved;
+    }
+
+    mipmap->levels[level] = current;
+    return current;
+}
+
+/**
+ * Picks what to sample when drawing the given region of an image at the given size.
+ *
+ * When the image is drawn at half its size or less, this is the smallest level of its mipmap that is still at
+ * least as large as the drawn size, so that every pixel of the source contributes.
+ *
+ * @return The image to sample from, with `region` moved to the same area of it.
+ *
+ * @internal
+ */
+static pntr_image* pntr_nuklear_get_mip_source(pntr_nuklear_context* state, pntr_image* image, pntr_rectangle* region, int width, int height) {
+    int level = 0;
+    while (level + 1 < PNTR_NUKLEAR_MAX_MIP_LEVELS && (region->width >> (level + 1)) >= width && (region->height >> (level + 1)) >= height) {
+        level++;
+    }
+    if (level == 0) {
+        return image;
+    }
+
+    pntr_image* mip = pntr_nuklear_get_mip_level(state, image, level);
+    if (mip == NULL) {
+        return image;
+    }
+
+    *region = pntr_nuklear_rect_intersect(
+        PNTR_CLITERAL(pntr_rectangle) { region->x >> level, region->y >> level, PNTR_NUKLEAR_MAX(region->width >> level, 1), PNTR_NUKLEAR_MAX(region->height >> level, 1) },
+        PNTR_CLITERAL(pntr_rectangle) { 0, 0, mip->width, mip->height }
+    );
+    return mip;
+}
+
+/**
+ * Makes a copy of an image's region, rescaled the way an image command draws it.
+ *
+ * @return The new image, or NULL when out of memory.
+ *
+ * @internal
+ */
+static pntr_image* pntr_nuklear_scale_image(pntr_nuklear_context* state, pntr_image* image, pntr_rectangle region, int width, int height) {
+    // Make the copy from the closest mipmap level.
+    pntr_rectangle sourceRegion = region;
+    pntr_image* source = pntr_nuklear_get_mip_source(state, image, &sourceRegion, width, height);
+    pntr_image* scaled;
+    if (sourceRegion.x == 0 && sourceRegion.y == 0 && sourceRegion.width == source->width && sourceRegion.height == source->height) {
+        scaled = pntr_image_resize(source, width, height, PNTR_FILTER_BILINEAR);
+    }
+    else {
+        pntr_image* cropped = pntr_image_from_image(source, sourceRegion.x, sourceRegion.y, sourceRegion.width, sourceRegion.height);
+        scaled = (cropped == NULL) ? NULL : pntr_image_resize(cropped, width, height, PNTR_FILTER_BILINEAR);
+        pntr_unload_image(cropped);
+    }
+    return scaled;
+}
+
+/**
+ * Finds the rescaled copy of an image command's region, making it when it isn't cached yet.
+ *
+ * @return The rescaled image, or NULL when it isn't cached and can't be made.
+ *
+ * @internal
+ */
+static pntr_image* pntr_nuklear_get_scaled_image(pntr_nuklear_context* state, pntr_image* image, pntr_rectangle region, int width, int height) {
+    int oldest = -1;
+    for (int i = 0; i < state->imageCacheCount; i++) {
+        pntr_nuklear_image_cache_entry* entry = &state->imageCache[i];
+        if (entry->source == image && entry->width == width && entry->height == height && pntr_nuklear_rect_equals(entry->region, region)) {
+            if (!state->imageCacheLocked) {
+                entry->lastUsed = ++state->imageCacheClock;
+                state->stats.imageCacheHits++;
+            }
+            return entry->scaled;
+        }
+        if (entry->lastUsed <= state->imageCacheFrame && (oldest < 0 || entry->lastUsed < state->imageCache[oldest].lastUsed)) {
+            oldest = i;
+        }
+    }
+
+    if (state->imageCacheLocked || width * height > PNTR_NUKLEAR_IMAGE_CACHE_MAX_PIXELS) {
+        return NULL;
+    }
+
+    // Replace the least recently used copy, growing rather than replacing copies this frame still draws.
+    if (state->imageCacheCount < PNTR_NUKLEAR_IMAGE_CACHE_SIZE || oldest < 0) {
+        pntr_nuklear_image_cache_entry* entries = (pntr_nuklear_image_cache_entry*)pntr_nuklear_grow(state->imageCache, &state->imageCacheCapacity, state->imageCacheCount + 1, sizeof(pntr_nuklear_image_cache_entry));
+        if (entries == NULL) {
+            return NULL;
+        }
+        state->imageCache = entries;
+        oldest = state->imageCacheCount++;
+        PNTR_MEMSET(&state->imageCache[oldest], 0, sizeof(pntr_nuklear_image_cache_entry));
+    }
+
+    pntr_image* scaled = pntr_nuklear_scale_image(state, image, region, width, height);
+    if (scaled == NULL) {
+        return NULL;
+    }
+
+    pntr_nuklear_image_cache_entry* entry = &state->imageCache[oldest];
+    pntr_unload_image(entry->scaled);
+    entry->source = image;
+    entry->region = region;
+    entry->width = width;
+    entry->height = height;
+    entry->scaled = scaled;
+    entry->lastUsed = ++state->imageCacheClock;
+    state->stats.imageCacheMisses++;
+    return scaled;
+}
+
+/**
+ * Retrieves the image that an image command draws, along with the region of it that is drawn.
+ *
+ * @return The image, or NULL when there is nothing to draw.
+ *
+ * @internal
+ */
+static pntr_image* pntr_nuklear_image_source(const struct nk_command_image* i, pntr_rectangle* srcRect) {
+    pntr_image* image = (pntr_image*)(i->img.handle.ptr);
+    if (image == NULL || i->w == 0 || i->h == 0) {
+        return NULL;
+    }
+
+    *srcRect = pntr_nuklear_rect_intersect(
+        PNTR_CLITERAL(pntr_rectangle) { i->img.region[0], i->img.region[1], i->img.region[2], i->img.region[3] },
+        PNTR_CLITERAL(pntr_rectangle) { 0, 0, image->width, image->height }
+    );
+    return pntr_nuklear_rect_empty(*srcRect) ? NULL : image;
+}
+
+/**
+ * Fills the image cache with the rescaled images that the collected commands will draw.
+ *
+ * @internal
+ */
+static void pntr_nuklear_prepare_images(pntr_nuklear_context* state) {
+    for (int index = 0; index < state->itemCount; index++) {
+        if (state->items[index].cmd->type != NK_COMMAND_IMAGE) {
+            continue;
+        }
+
+        const struct nk_command_image* i = (const struct nk_command_image*)state->items[index].cmd;
+        pntr_rectangle srcRect;
+        pntr_image* image = pntr_nuklear_image_source(i, &srcRect);
+        if (image != NULL && (i->w != srcRect.width || i->h != srcRect.height)) {
+            if (pntr_nuklear_get_scaled_image(state, image, srcRect, i->w, i->h) == NULL) {
+                pntr_nuklear_get_mip_source(state, image, &srcRect, i->w, i->h);
+            }
+        }
+    }
+}
+
+/**
+ * Draws an image command, avoiding bilinear filtering whenever the image isn't resized.
+ *
+ * Resized images are drawn from a cached copy, rescaled and then tinted the same way as
+ * pntr_draw_image_scaled_rec().
+ *
+ * @internal
+ */
+static void pntr_nuklear_draw_image(pntr_image* dst, const struct nk_command_image* i, pntr_nuklear_context* state) {
+    pntr_rectangle srcRect;
+    pntr_image* image = pntr_nuklear_image_source(i, &srcRect);
+    if (image == NULL) {
+        return;
+    }
+
+    pntr_color tint = pntr_nk_color_to_color(i->col);
+
+    // Drawn as is.
+    if (i->w == srcRect.width && i->h == srcRect.height) {
+        pntr_nuklear_blit(dst, image, srcRect, i->x, i->y, tint);
+        return;
+    }
+
+    // Resized, so draw a cached copy rescaled to the same size, tinting it as it is drawn.
+    pntr_image* scaled = pntr_nuklear_get_scaled_image(state, image, srcRect, i->w, i->h);
+    if (scaled != NULL) {
+        pntr_nuklear_blit(dst, scaled, PNTR_CLITERAL(pntr_rectangle) { 0, 0, scaled->width, scaled->height }, i->x, i->y, tint);
+        return;
+    }
+
+    // Not in the cache, so rescale a copy the same way just for this command, keeping the pixels the same.
+    if (i->w * i->h <= PNTR_NUKLEAR_IMAGE_CACHE_MAX_PIXELS) {
+        scaled = pntr_nuklear_scale_image(state, image, srcRect, i->w, i->h);
+        if (scaled != NULL) {
+            pntr_nuklear_blit(dst, scaled, PNTR_CLITERAL(pntr_rectangle) { 0, 0, scaled->width, scaled->height }, i->x, i->y, tint);
+            pntr_unload_image(scaled);
+            return;
+        }
+    }
+
+    // Too large to cache, so sample from the closest mipmap level directly.
+    image = pntr_nuklear_get_mip_source(state, image, &srcRect, i->w, i->h);
+    pntr_draw_image_scaled_rec(dst, image, srcRect, i->x, i->y, (float)i->w / (float)srcRect.width, (float)i->h / (float)srcRect.height, 0, 0, PNTR_FILTER_BILINEAR, tint);
+}
+
+/**
+ * Draws a single nuklear command on the destination image.
+ *
+ * @param worker Which of the context's scratch memory to use, so that threads don't share it.
+ *
+ * @internal
+ */
+static void pntr_nuklear_draw_command(pntr_image* dst, const struct nk_command* cmd, pntr_nuklear_context* state, int worker) {
+    pntr_nuklear_scratch* scratch = &state->scratch[worker];
+    switch (cmd->type) {
+        case NK_COMMAND_NOP: {
+            break;
+        }
+
+        case NK_COMMAND_SCISSOR: {
+            const struct nk_command_scissor *s =(const struct nk_command_scissor*)cmd;
+            pntr_image_set_clip(dst, s->x, s->y, s->w, s->h);
+        } break;
+
+        case NK_COMMAND_LINE: {
+            const struct nk_command_line *l = (const struct nk_command_line *)cmd;
+            pntr_draw_line_thick(dst,
+                l->begin.x, l->begin.y,
+                l->end.x, l->end.y,
+                (int)l->line_thickness,
+                pntr_nk_color_to_color(l->color)
+            );
+        } break;
+
+        case NK_COMMAND_CURVE: {
+            const struct nk_command_curve *q = (const struct nk_command_curve *)cmd;
+            pntr_draw_line_curve_thick(dst,
+                pntr_nk_vec2i_to_vector(q->begin),
+                pntr_nk_vec2i_to_vector(q->ctrl[0]),
+                pntr_nk_vec2i_to_vector(q->ctrl[1]),
+                pntr_nk_vec2i_to_vector(q->end),
+                pntr_nuklear_curve_segments(q, state->curveTolerance),
+                (int)q->line_thickness,
+                pntr_nk_color_to_color(q->color)
+            );
+        } break;
+
+        case NK_COMMAND_RECT: {
+            const struct nk_command_rect *r = (const struct nk_command_rect *)cmd;
+            pntr_color color = pntr_nk_color_to_color(r->color);
+            int rounding = (int)r->rounding;
+            if (rounding == 0) {
+                pntr_nuklear_fill_rect_outline(dst, PNTR_CLITERAL(pntr_rectangle) { (int)r->x, (int)r->y, (int)r->w, (int)r->h }, (int)r->line_thickness, color);
+                break;
+            }
+            pntr_draw_rectangle_thick_rounded(dst,
+                (int)r->x, (int)r->y,
+                (int)r->w, (int)r->h,
+                rounding, rounding, rounding, rounding,
+                (int)r->line_thickness,
+                color
+            );
+        } break;
+
+        case NK_COMMAND_RECT_FILLED: {
+            const struct nk_command_rect_filled *r = (const struct nk_command_rect_filled *)cmd;
+            if (r->rounding == 0) {
+                pntr_nuklear_fill_rect(dst, PNTR_CLITERAL(pntr_rectangle) { (int)r->x, (int)r->y, (int)r->w, (int)r->h }, pntr_nk_color_to_color(r->color));
+                break;
+            }
+            pntr_draw_rectangle_rounded_fill(dst, (int)r->x, (int)r->y, (int)r->w, (int)r->h, (int)r->rounding, pntr_nk_color_to_color(r->color));
+        } break;
+
+        case NK_COMMAND_RECT_MULTI_COLOR: {
+            const struct nk_command_rect_multi_color* rectangle = (const struct nk_command_rect_multi_color *)cmd;
+            pntr_draw_rectangle_gradient_rec(dst,
+                PNTR_CLITERAL(pntr_rectangle) {(int)rectangle->x, (int)rectangle->y, (int)rectangle->w, (int)rectangle->h},
+                pntr_nk_color_to_color(rectangle->left),
+                pntr_nk_color_to_color(rectangle->top),
+                pntr_nk_color_to_color(rectangle->bottom),
+                pntr_nk_color_to_color(rectangle->right)
+            );
+        } break;
+
+        case NK_COMMAND_CIRCLE: {
+            const struct nk_command_circle *c = (const struct nk_command_circle *)cmd;
+            pntr_color color = pntr_nk_color_to_color(c->color);
+            if (c->w == c->h) {
+                pntr_draw_circle_thick(dst, c->x + c->w / 2, c->y + c->h / 2, c->w / 2 + 1, (int)c->line_thickness, color);
+            }
+            else {
+                pntr_draw_ellipse_thick(dst, c->x + c->w / 2, c->y + c->h / 2, c->w / 2 + 1, c->h / 2 + 1, (int)c->line_thickness, color);
+            }
+        } break;
+
+        case NK_COMMAND_CIRCLE_FILLED: {
+            const struct nk_command_circle_filled *c = (const struct nk_command_circle_filled *)cmd;
+            pntr_color color = pntr_nk_color_to_color(c->color);
+            if (c->w == c->h) {
+                pntr_draw_circle_fill(dst, c->x + c->w / 2, c->y + c->h / 2, c->w / 2 + 1, color);
+            }
+            else {
+                pntr_draw_ellipse_fill(dst, c->x + c->w / 2, c->y + c->h / 2, c->w / 2 + 1, c->h / 2 + 1, color);
+            }
+        } break;
+
+        case NK_COMMAND_ARC: {
+            const struct nk_command_arc *a = (const struct nk_command_arc*)cmd;
+            float startAngle = a->a[0] * 180.0f / PNTR_PI;
+            float endAngle = a->a[1] * 180.0f / PNTR_PI;
+            int segments = pntr_nuklear_arc_segments((float)a->r, a->a[0], a->a[1], state->curveTolerance);
+            pntr_draw_arc_thick(dst, a->cx, a->cy, a->r, startAngle, endAngle, segments, (int)a->line_thickness, pntr_nk_color_to_color(a->color));
+        } break;
+
+        case NK_COMMAND_ARC_FILLED: {
+            const struct nk_command_arc_filled *a = (const struct nk_command_arc_filled*)cmd;
+            pntr_color color = pntr_nk_color_to_color(a->color);
+
+            float startAngle = a->a[0] * 180.0f / PNTR_PI;
+            float endAngle = a->a[1] * 180.0f / PNTR_PI;
+
+            int segments = pntr_nuklear_arc_segments((float)a->r, a->a[0], a->a[1], state->curveTolerance);
+            pntr_draw_arc_fill(dst, (int)a->cx, (int)a->cy, a->r, startAngle, endAngle, segments, color);
+        } break;
+
+        case NK_COMMAND_TRIANGLE: {
+            const struct nk_command_triangle *t = (const struct nk_command_triangle*)cmd;
+            pntr_color color = pntr_nk_color_to_color(t->color);
+            pntr_draw_triangle_thick(dst, t->b.x, t->b.y, t->a.x, t->a.y, t->c.x, t->c.y, (int)t->line_thickness, color);
+        } break;
+
+        case NK_COMMAND_TRIANGLE_FILLED: {
+            const struct nk_command_triangle_filled *t = (const struct nk_command_triangle_filled*)cmd;
+            struct nk_vec2i points[3] = { t->a, t->b, t->c };
+            pntr_nuklear_fill_polygon(dst, points, 3, pntr_nk_color_to_color(t->color), scratch);
+        } break;
+
+        case NK_COMMAND_POLYGON: {
+            const struct nk_command_polygon *p = (const struct nk_command_polygon*)cmd;
+            pntr_color color = pntr_nk_color_to_color(p->color);
+            int count = p->point_count;
+            pntr_vector* points = pntr_nuklear_convert_points(scratch, p->points, count);
+            if (points == NULL) {
+                break;
+            }
+            pntr_draw_polygon_thick(dst, points, count, (int)p->line_thickness, color);
+        } break;
+
+        case NK_COMMAND_POLYGON_FILLED: {
+            const struct nk_command_polygon_filled *p = (const struct nk_command_polygon_filled*)cmd;
+            pntr_nuklear_fill_polygon(dst, p->points, p->point_count, pntr_nk_color_to_color(p->color), scratch);
+        } break;
+
+        case NK_COMMAND_POLYLINE: {
+            const struct nk_command_polyline *p = (const struct nk_command_polyline *)cmd;
+            pntr_color color = pntr_nk_color_to_color(p->color);
+            int count = p->point_count;
+            pntr_vector* points = pntr_nuklear_convert_points(scratch, p->points, count);
+            if (points == NULL) {
+                break;
+            }
+            pntr_draw_polyline_thick(dst, points, count, (int)p->line_thickness, color);
+        } break;
+
+        case NK_COMMAND_TEXT: {
+            const struct nk_command_text *text = (const struct nk_command_text*)cmd;
+            // Don't draw the text background by default.
+            #ifdef PNTR_NUKLEAR_DRAW_TEXT_BACKGROUND
+            if (text->background.a > 0) {
+                pntr_nuklear_fill_rect(dst, PNTR_CLITERAL(pntr_rectangle) { text->x, text->y, text->w, text->h }, pntr_nk_color_to_color(text->background));
+            }
+            #endif
+            pntr_nuklear_draw_text(dst, text);
+        } break;
+
+        case NK_COMMAND_IMAGE: {
+            pntr_nuklear_draw_image(dst, (const struct nk_command_image *)cmd, state);
+        } break;
+
+        case NK_COMMAND_CUSTOM: {
+            const struct nk_command_custom *custom = (const struct nk_command_custom *)cmd;
+            custom->callback(NULL, (short)(custom->x), (short)(custom->y), (unsigned short)(custom->w), (unsigned short)(custom->h), custom->callback_data);
+        } break;
+
+        default: {
+            //TraceLog(LOG_WARNING, "NUKLEAR: Missing implementation %i", cmd->type);
+        } break;
+    }
+}
+
+/**
+ * The number of bytes a command uses in the command buffer.
+ *
+ * @internal
+ */
+static nk_size pntr_nuklear_command_size(const struct nk_command* cmd) {
+    switch (cmd->type) {
+        case NK_COMMAND_SCISSOR: return sizeof(struct nk_command_scissor);
+        case NK_COMMAND_LINE: return sizeof(struct nk_command_line);
+        case NK_COMMAND_CURVE: return sizeof(struct nk_command_curve);
+        case NK_COMMAND_RECT: return sizeof(struct nk_command_rect);
+        case NK_COMMAND_RECT_FILLED: return sizeof(struct nk_command_rect_filled);
+        case NK_COMMAND_RECT_MULTI_COLOR: return sizeof(struct nk_command_rect_multi_color);
+        case NK_COMMAND_CIRCLE: return sizeof(struct nk_command_circle);
+        case NK_COMMAND_CIRCLE_FILLED: return sizeof(struct nk_command_circle_filled);
+        case NK_COMMAND_ARC: return sizeof(struct nk_command_arc);
+        case NK_COMMAND_ARC_FILLED: return sizeof(struct nk_command_arc_filled);
+        case NK_COMMAND_TRIANGLE: return sizeof(struct nk_command_triangle);
+        case NK_COMMAND_TRIANGLE_FILLED: return sizeof(struct nk_command_triangle_filled);
+        case NK_COMMAND_POLYGON: return sizeof(struct nk_command_polygon) + sizeof(short) * 2 * ((const struct nk_command_polygon*)cmd)->point_count;
+        case NK_COMMAND_POLYGON_FILLED: return sizeof(struct nk_command_polygon_filled) + sizeof(short) * 2 * ((const struct nk_command_polygon_filled*)cmd)->point_count;
+        case NK_COMMAND_POLYLINE: return sizeof(struct nk_command_polyline) + sizeof(short) * 2 * ((const struct nk_command_polyline*)cmd)->point_count;
+        case NK_COMMAND_IMAGE: return sizeof(struct nk_command_image);
+        case NK_COMMAND_CUSTOM: return sizeof(struct nk_command_custom);
+        case NK_COMMAND_TEXT: return sizeof(struct nk_command_text) + (nk_size)(((const struct nk_command_text*)cmd)->length + 1);
+        default: return sizeof(struct nk_command);
+    }
+}
+
+/**
+ * Hashes what a command draws, skipping the header's buffer offsets, which change every frame.
+ *
+ * Padding between the fields is zeroed through NK_ZERO_COMMAND_MEMORY.
+ *
+ * @internal
+ */
+static uint64_t pntr_nuklear_command_hash(uint64_t hash, const struct nk_command* cmd) {
+    hash = pntr_nuklear_hash(hash, &cmd->type, sizeof(cmd->type));
+    nk_size size = pntr_nuklear_command_size(cmd);
+    return pntr_nuklear_hash(hash, (const unsigned char*)cmd + sizeof(struct nk_command), size - sizeof(struct nk_command));
+}
+
+/**
+ * Builds a rectangle from the given corners, padded on each side.
+ *
+ * @internal
+ */
+static pntr_rectangle pntr_nuklear_rect_from_points(const struct nk_vec2i* points, int count, int padding) {
+    if (count <= 0) {
+        return PNTR_CLITERAL(pntr_rectangle) { 0, 0, 0, 0 };
+    }
+
+    int x1 = points[0].x, y1 = points[0].y, x2 = points[0].x, y2 = points[0].y;
+    for (int i = 1; i < count; i++) {
+        x1 = PNTR_NUKLEAR_MIN(x1, points[i].x);
+        y1 = PNTR_NUKLEAR_MIN(y1, points[i].y);
+        x2 = PNTR_NUKLEAR_MAX(x2, points[i].x);
+        y2 = PNTR_NUKLEAR_MAX(y2, points[i].y);
+    }
+
+    return PNTR_CLITERAL(pntr_rectangle) { x1 - padding, y1 - padding, x2 - x1 + 1 + padding * 2, y2 - y1 + 1 + padding * 2 };
+}
+
+/**
+ * A conservative estimate of the pixels the given command may touch, before clipping.
+ *
+ * @internal
+ */
+static pntr_rectangle pntr_nuklear_command_bounds(const struct nk_command* cmd) {
+    switch (cmd->type) {
+        case NK_COMMAND_LINE: {
+            const struct nk_command_line *l = (const struct nk_command_line *)cmd;
+            struct nk_vec2i points[2] = { l->begin, l->end };
+            return pntr_nuklear_rect_from_points(points, 2, l->line_thickness + 1);
+        }
+        case NK_COMMAND_CURVE: {
+            // The curve stays within the hull of its control points.
+            const struct nk_command_curve *q = (const struct nk_command_curve *)cmd;
+            struct nk_vec2i points[4] = { q->begin, q->ctrl[0], q->ctrl[1], q->end };
+            return pntr_nuklear_rect_from_points(points, 4, q->line_thickness + 1);
+        }
+        case NK_COMMAND_RECT: {
+            const struct nk_command_rect *r = (const struct nk_command_rect *)cmd;
+            int padding = r->line_thickness + 1;
+            return PNTR_CLITERAL(pntr_rectangle) { r->x - padding, r->y - padding, r->w + padding * 2, r->h + padding * 2 };
+        }
+        case NK_COMMAND_RECT_FILLED: {
+            const struct nk_command_rect_filled *r = (const struct nk_command_rect_filled *)cmd;
+            return PNTR_CLITERAL(pntr_rectangle) { r->x, r->y, r->w, r->h };
+        }
+        case NK_COMMAND_RECT_MULTI_COLOR: {
+            const struct nk_command_rect_multi_color *r = (const struct nk_command_rect_multi_color *)cmd;
+            return PNTR_CLITERAL(pntr_rectangle) { r->x, r->y, r->w, r->h };
+        }
+        case NK_COMMAND_CIRCLE: {
+            const struct nk_command_circle *c = (const struct nk_command_circle *)cmd;
+            int padding = c->line_thickness + 2;
+            return PNTR_CLITERAL(pntr_rectangle) { c->x - padding, c->y - padding, c->w + padding * 2, c->h + padding * 2 };
+        }
+        case NK_COMMAND_CIRCLE_FILLED: {
+            const struct nk_command_circle_filled *c = (const struct nk_command_circle_filled *)cmd;
+            return PNTR_CLITERAL(pntr_rectangle) { c->x - 2, c->y - 2, c->w + 4, c->h + 4 };
+        }
+        case NK_COMMAND_ARC: {
+            const struct nk_command_arc *a = (const struct nk_command_arc *)cmd;
+            int radius = a->r + a->line_thickness + 1;
+            return PNTR_CLITERAL(pntr_rectangle) { a->cx - radius, a->cy - radius, radius * 2 + 1, radius * 2 + 1 };
+        }
+        case NK_COMMAND_ARC_FILLED: {
+            const struct nk_command_arc_filled *a = (const struct nk_command_arc_filled *)cmd;
+            int radius = a->r + 1;
+            return PNTR_CLITERAL(pntr_rectangle) { a->cx - radius, a->cy - radius, radius * 2 + 1, radius * 2 + 1 };
+        }
+        case NK_COMMAND_TRIANGLE: {
+            const struct nk_command_triangle *t = (const struct nk_command_triangle *)cmd;
+            struct nk_vec2i points[3] = { t->a, t->b, t->c };
+            return pntr_nuklear_rect_from_points(points, 3, t->line_thickness + 1);
+        }
+        case NK_COMMAND_TRIANGLE_FILLED: {
+            const struct nk_command_triangle_filled *t = (const struct nk_command_triangle_filled *)cmd;
+            struct nk_vec2i points[3] = { t->a, t->b, t->c };
+            return pntr_nuklear_rect_from_points(points, 3, 1);
+        }
+        case NK_COMMAND_POLYGON: {
+            const struct nk_command_polygon *p = (const struct nk_command_polygon *)cmd;
+            return pntr_nuklear_rect_from_points(p->points, p->point_count, p->line_thickness + 1);
+        }
+        case NK_COMMAND_POLYGON_FILLED: {
+            const struct nk_command_polygon_filled *p = (const struct nk_command_polygon_filled *)cmd;
+            return pntr_nuklear_rect_from_points(p->points, p->point_count, 1);
+        }
+        case NK_COMMAND_POLYLINE: {
+            const struct nk_command_polyline *p = (const struct nk_command_polyline *)cmd;
+            return pntr_nuklear_rect_from_points(p->points, p->point_count, p->line_thickness + 1);
+        }
+        case NK_COMMAND_TEXT: {
+            // Glyphs may hang outside of the text's box, so give it a line of room on each side.
+            const struct nk_command_text *t = (const struct nk_command_text *)cmd;
+            return PNTR_CLITERAL(pntr_rectangle) { t->x - t->h, t->y - t->h, t->w + t->h * 2, t->h * 3 };
+        }
+        case NK_COMMAND_IMAGE: {
+            const struct nk_command_image *i = (const struct nk_command_image *)cmd;
+            return PNTR_CLITERAL(pntr_rectangle) { i->x, i->y, i->w + 1, i->h + 1 };
+        }
+        case NK_COMMAND_CUSTOM: {
+            const struct nk_command_custom *c = (const struct nk_command_custom *)cmd;
+            return PNTR_CLITERAL(pntr_rectangle) { c->x, c->y, c->w, c->h };
+        }
+        default: {
+            return PNTR_CLITERAL(pntr_rectangle) { 0, 0, 0, 0 };
+        }
+    }
+}
+
+/**
+ * Checks whether the given command would draw nothing, no matter where it is drawn.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_command_invisible(const struct nk_command* cmd) {
+    switch (cmd->type) {
+        case NK_COMMAND_NOP: return true;
+        case NK_COMMAND_LINE: return ((const struct nk_command_line*)cmd)->color.a == 0;
+        case NK_COMMAND_CURVE: return ((const struct nk_command_curve*)cmd)->color.a == 0;
+        case NK_COMMAND_RECT: return ((const struct nk_command_rect*)cmd)->color.a == 0;
+        case NK_COMMAND_RECT_FILLED: {
+            const struct nk_command_rect_filled* r = (const struct nk_command_rect_filled*)cmd;
+            return r->color.a == 0 || r->w == 0 || r->h == 0;
+        }
+        case NK_COMMAND_RECT_MULTI_COLOR: {
+            const struct nk_command_rect_multi_color* r = (const struct nk_command_rect_multi_color*)cmd;
+            return (r->left.a == 0 && r->top.a == 0 && r->bottom.a == 0 && r->right.a == 0) || r->w == 0 || r->h == 0;
+        }
+        case NK_COMMAND_CIRCLE: return ((const struct nk_command_circle*)cmd)->color.a == 0;
+        case NK_COMMAND_CIRCLE_FILLED: return ((const struct nk_command_circle_filled*)cmd)->color.a == 0;
+        case NK_COMMAND_ARC: return ((const struct nk_command_arc*)cmd)->color.a == 0;
+        case NK_COMMAND_ARC_FILLED: return ((const struct nk_command_arc_filled*)cmd)->color.a == 0;
+        case NK_COMMAND_TRIANGLE: return ((const struct nk_command_triangle*)cmd)->color.a == 0;
+        case NK_COMMAND_TRIANGLE_FILLED: return ((const struct nk_command_triangle_filled*)cmd)->color.a == 0;
+        case NK_COMMAND_POLYGON: {
+            const struct nk_command_polygon* p = (const struct nk_command_polygon*)cmd;
+            return p->color.a == 0 || p->point_count == 0;
+        }
+        case NK_COMMAND_POLYGON_FILLED: {
+            const struct nk_command_polygon_filled* p = (const struct nk_command_polygon_filled*)cmd;
+            return p->color.a == 0 || p->point_count == 0;
+        }
+        case NK_COMMAND_POLYLINE: {
+            const struct nk_command_polyline* p = (const struct nk_command_polyline*)cmd;
+            return p->color.a == 0 || p->point_count == 0;
+        }
+        case NK_COMMAND_TEXT: {
+            const struct nk_command_text* t = (const struct nk_command_text*)cmd;
+            #ifdef PNTR_NUKLEAR_DRAW_TEXT_BACKGROUND
+            if (t->background.a > 0) {
+                return false;
+            }
+            #endif
+            return t->foreground.a == 0 || t->length == 0 || t->string[0] == '\0';
+        }
+        case NK_COMMAND_IMAGE: {
+            const struct nk_command_image* i = (const struct nk_command_image*)cmd;
+            return i->col.a == 0 || i->w == 0 || i->h == 0 || i->img.handle.ptr == NULL;
+        }
+        default: return false;
+    }
+}
+
+/**
+ * Walks the context's command list, collecting each command with its clip and bounds.
+ *
+ * Scissor commands are folded into the clip of the commands that follow them. No-ops, and commands that are
+ * invisible or fully clipped, are left out. Commands are only hashed when `hash` is true.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_collect(pntr_nuklear_context* state, pntr_image* dst, bool hash) {
+    pntr_rectangle screen = PNTR_CLITERAL(pntr_rectangle) { 0, 0, dst->width, dst->height };
+    pntr_rectangle clip = dst->clip;
+    const struct nk_command *cmd;
+
+    bool scissorUnused = false;
+
+    pntr_nuklear_trim_image_cache(state);
+
+    state->itemCount = 0;
+    nk_foreach(cmd, &state->ctx) {
+        if (cmd->type == NK_COMMAND_SCISSOR) {
+            // A scissor replaced before anything used it has no effect.
+            if (scissorUnused) {
+                state->stats.droppedCommands++;
+            }
+            scissorUnused = true;
+
+            const struct nk_command_scissor *s = (const struct nk_command_scissor*)cmd;
+            clip = pntr_nuklear_rect_intersect(PNTR_CLITERAL(pntr_rectangle) { s->x, s->y, s->w, s->h }, screen);
+            continue;
+        }
+
+        // Custom commands are always kept, as their callbacks may do more than draw.
+        pntr_rectangle bounds = pntr_nuklear_rect_intersect(pntr_nuklear_command_bounds(cmd), clip);
+        if (cmd->type != NK_COMMAND_CUSTOM && (pntr_nuklear_command_invisible(cmd) || pntr_nuklear_rect_empty(bounds))) {
+            state->stats.droppedCommands++;
+            continue;
+        }
+        scissorUnused = false;
+
+        pntr_nuklear_item* items = (pntr_nuklear_item*)pntr_nuklear_grow(state->items, &state->itemCapacity, state->itemCount + 1, sizeof(pntr_nuklear_item));
+        if (items == NULL) {
+            return false;
+        }
+        state->items = items;
+
+        pntr_nuklear_item* item = &state->items[state->itemCount++];
+        item->cmd = cmd;
+        item->clip = clip;
+        item->bounds = bounds;
+        item->hash = hash ? pntr_nuklear_hash(pntr_nuklear_command_hash(PNTR_NUKLEAR_HASH_SEED, cmd), &clip, sizeof(pntr_rectangle)) : 0;
+    }
+
+    return true;
+}
+
+/**
+ * Drops the collected commands that a later opaque rectangle completely covers, as they would be painted over.
+ *
+ * Custom commands are always kept.
+ *
+ * @internal
+ */
+static void pntr_nuklear_cull(pntr_nuklear_context* state) {
+    pntr_rectangle occluders[PNTR_NUKLEAR_MAX_OCCLUDERS];
+    int occluderCount = 0;
+
+    // Walk from the top down, so that each command is tested against what is drawn after it.
+    int write = state->itemCount;
+    for (int i = state->itemCount - 1; i >= 0; i--) {
+        pntr_nuklear_item item = state->items[i];
+        if (item.cmd->type != NK_COMMAND_CUSTOM && !pntr_nuklear_rect_empty(item.bounds)) {
+            bool covered = false;
+            for (int o = 0; o < occluderCount && !covered; o++) {
+                covered = pntr_nuklear_rect_contains(occluders[o], item.bounds);
+            }
+            if (covered) {
+                state->stats.culledCommands++;
+                continue;
+            }
+        }
+        state->items[--write] = item;
+
+        // Unrounded opaque fills hide everything under them.
+        if (item.cmd->type != NK_COMMAND_RECT_FILLED) {
+            continue;
+        }
+        const struct nk_command_rect_filled* r = (const struct nk_command_rect_filled*)item.cmd;
+        if (r->rounding != 0 || r->color.a != 255) {
+            continue;
+        }
+        pntr_rectangle area = pntr_nuklear_rect_intersect(PNTR_CLITERAL(pntr_rectangle) { r->x, r->y, r->w, r->h }, item.clip);
+        if (pntr_nuklear_rect_empty(area)) {
+            continue;
+        }
+
+        if (occluderCount < PNTR_NUKLEAR_MAX_OCCLUDERS) {
+            occluders[occluderCount++] = area;
+            continue;
+        }
+
+        // Replace the smallest occluder when this one is larger.
+        int smallest = 0;
+        for (int o = 1; o < occluderCount; o++) {
+            if (occluders[o].width * occluders[o].height < occluders[smallest].width * occluders[smallest].height) {
+                smallest = o;
+            }
+        }
+        if (area.width * area.height > occluders[smallest].width * occluders[smallest].height) {
+            occluders[smallest] = area;
+        }
+    }
+
+    // Move what is left to the front.
+    state->itemCount -= write;
+    if (write > 0) {
+        for (int i = 0; i < state->itemCount; i++) {
+            state->items[i] = state->items[write + i];
+        }
+    }
+}
+
+/**
+ * Adds a damaged area, merging it with the damage it overlaps so that the damage rectangles never overlap.
+ *
+ * @internal
+ */
+static void pntr_nuklear_add_damage(pntr_nuklear_context* state, pntr_rectangle rect) {
+    if (pntr_nuklear_rect_empty(rect)) {
+        return;
+    }
+
+    int i = 0;
+    while (i < state->damageCount) {
+        if (pntr_nuklear_rect_overlaps(state->damage[i], rect)) {
+            // Absorb the overlapping rectangle, and check all of them again with the bigger area.
+            rect = pntr_nuklear_rect_union(state->damage[i], rect);
+            state->damage[i] = state->damage[--state->damageCount];
+            i = 0;
+            continue;
+        }
+
+        if (i == state->damageCount - 1 && state->damageCount == PNTR_NUKLEAR_MAX_DAMAGE_RECTS) {
+            // Out of room, so merge with the rectangle that grows the least.
+            int best = 0;
+            long bestGrowth = -1;
+            for (int j = 0; j < state->damageCount; j++) {
+                pntr_rectangle merged = pntr_nuklear_rect_union(state->damage[j], rect);
+                long growth = (long)merged.width * merged.height - (long)state->damage[j].width * state->damage[j].height;
+                if (bestGrowth < 0 || growth < bestGrowth) {
+                    best = j;
+                    bestGrowth = growth;
+                }
+            }
+            rect = pntr_nuklear_rect_union(state->damage[best], rect);
+            state->damage[best] = state->damage[--state->damageCount];
+            i = 0;
+            continue;
+        }
+
+        i++;
+    }
+
+    state->damage[state->damageCount++] = rect;
+}
+
+/**
+ * Compares the collected commands with the previous frame's, and marks the areas of those that differ.
+ *
+ * Commands are matched up in order, so any command left unmatched in either frame, along with its area, is damaged.
+ *
+ * @internal
+ */
+static void pntr_nuklear_compute_damage(pntr_nuklear_context* state) {
+    int cursor = 0;
+    for (int i = 0; i < state->itemCount; i++) {
+        const pntr_nuklear_item* item = &state->items[i];
+        int found = -1;
+        int last = PNTR_NUKLEAR_MIN(state->previousCount, cursor + PNTR_NUKLEAR_DAMAGE_LOOKAHEAD);
+        for (int j = cursor; j < last; j++) {
+            if (state->previous[j].hash == item->hash && pntr_nuklear_rect_equals(state->previous[j].bounds, item->bounds)) {
+                found = j;
+                break;
+            }
+        }
+
+        if (found < 0) {
+            pntr_nuklear_add_damage(state, item->bounds);
+            continue;
+        }
+
+        // Everything skipped over in the previous frame is gone.
+        for (int j = cursor; j < found; j++) {
+            pntr_nuklear_add_damage(state, state->previous[j].bounds);
+        }
+        cursor = found + 1;
+    }
+
+    for (int j = cursor; j < state->previousCount; j++) {
+        pntr_nuklear_add_damage(state, state->previous[j].bounds);
+    }
+}
+
+/**
+ * Replaces the pixels of the given area with a color, without blending.
+ *
+ * @internal
+ */
+static void pntr_nuklear_clear_rect(pntr_image* dst, pntr_rectangle rect, pntr_color color) {
+    rect = pntr_nuklear_rect_intersect(rect, PNTR_CLITERAL(pntr_rectangle) { 0, 0, dst->width, dst->height });
+    for (int y = rect.y; y < rect.y + rect.height; y++) {
+        pntr_nuklear_store_span(dst->data + y * (dst->pitch >> 2) + rect.x, rect.width, color);
+    }
+}
+
+/**
+ * Hashes the whole command list, along with the image it is drawn to.
+ *
+ * @internal
+ */
+static uint64_t pntr_nuklear_frame_hash(struct nk_context* ctx, pntr_image* dst) {
+    const struct nk_command *cmd;
+    uint64_t hash = pntr_nuklear_hash(PNTR_NUKLEAR_HASH_SEED, &dst->width, sizeof(dst->width));
+    hash = pntr_nuklear_hash(hash, &dst->height, sizeof(dst->height));
+    nk_foreach(cmd, ctx) {
+        hash = pntr_nuklear_command_hash(hash, cmd);
+    }
+    return hash;
+}
+
+/**
+ * Checks whether the frame is the same as the last one drawn, when skipping unchanged frames is enabled.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_skip_frame(pntr_nuklear_context* state, pntr_image* dst) {
+    if (!state->skipUnchanged) {
+        return false;
+    }
+
+    uint64_t hash = pntr_nuklear_frame_hash(&state->ctx, dst);
+    if (hash == state->frameHash && dst == state->frameTarget) {
+        return true;
+    }
+
+    state->frameHash = hash;
+    state->frameTarget = dst;
+    return false;
+}
+
+/**
+ * Makes the next frame redraw everything, rather than skipping or reusing what was drawn before.
+ *
+ * @internal
+ */
+static void pntr_nuklear_redraw(pntr_nuklear_context* state) {
+    state->invalidated = true;
+    state->frameTarget = NULL;
+    for (int i = 0; i < state->layerCount; i++) {
+        state->layers[i].rendered = false;
+    }
+}
+
+/**
+ * Runs a collected custom command on the destination image, clipped as it is by pntr_draw_nuklear().
+ *
+ * @internal
+ */
+static void pntr_nuklear_draw_custom(pntr_image* dst, const pntr_nuklear_item* item, pntr_nuklear_context* state) {
+    pntr_rectangle clip = dst->clip;
+    pntr_image_set_clip(dst, item->clip.x, item->clip.y, item->clip.width, item->clip.height);
+    pntr_nuklear_draw_command(dst, item->cmd, state, 0);
+    pntr_image_set_clip(dst, clip.x, clip.y, clip.width, clip.height);
+}
+
+/**
+ * Finds the next custom command from the given collected command, or the end of the commands.
+ *
+ * @internal
+ */
+static int pntr_nuklear_next_custom(pntr_nuklear_context* state, int first) {
+    while (first < state->itemCount && state->items[first].cmd->type != NK_COMMAND_CUSTOM) {
+        first++;
+    }
+    return first;
+}
+
+/**
+ * What the tile jobs of pntr_draw_nuklear_tiled() draw.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_tiles {
+    pntr_nuklear_context* state;
+    pntr_image* dst;
+    int columns;
+    int first;  // The first collected command to draw.
+    int last;   // One past the last collected command to draw.
+} pntr_nuklear_tiles;
+
+/**
+ * Draws the commands from `first` to `last` binned into one tile, clipped to the tile.
+ *
+ * @internal
+ */
+static void pntr_nuklear_draw_tile(void* data, int index, int worker) {
+    pntr_nuklear_tiles* tiles = (pntr_nuklear_tiles*)data;
+    pntr_nuklear_context* state = tiles->state;
+
+    // Each tile gets its own view of the image, so that the clip isn't shared between threads.
+    pntr_image target = *tiles->dst;
+    pntr_rectangle tile = pntr_nuklear_rect_intersect(
+        PNTR_CLITERAL(pntr_rectangle) {
+            (index % tiles->columns) * PNTR_NUKLEAR_TILE_SIZE,
+            (index / tiles->columns) * PNTR_NUKLEAR_TILE_SIZE,
+            PNTR_NUKLEAR_TILE_SIZE,
+            PNTR_NUKLEAR_TILE_SIZE
+        },
+        PNTR_CLITERAL(pntr_rectangle) { 0, 0, target.width, target.height }
+    );
+
+    for (int i = state->tileStart[index]; i < state->tileStart[index + 1]; i++) {
+        // Each tile's commands are in order, so skip to the first one and stop after the last.
+        if (state->tileItems[i] < tiles->first) {
+            continue;
+        }
+        if (state->tileItems[i] >= tiles->last) {
+            break;
+        }
+
+        const pntr_nuklear_item* item = &state->items[state->tileItems[i]];
+        pntr_rectangle clip = pntr_nuklear_rect_intersect(item->clip, tile);
+        pntr_image_set_clip(&target, clip.x, clip.y, clip.width, clip.height);
+        pntr_nuklear_draw_command(&target, item->cmd, state, worker);
+    }
+}
+
+/**
+ * Bins each collected command into the tiles its bounds touch, keeping the commands in order within each tile.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_bin_tiles(pntr_nuklear_context* state, int columns, int rows) {
+    int tileCount = columns * rows;
+    int* tileStart = (int*)pntr_nuklear_grow(state->tileStart, &state->tileStartCapacity, tileCount + 1, sizeof(int));
+    if (tileStart == NULL) {
+        return false;
+    }
+    state->tileStart = tileStart;
+    PNTR_MEMSET(tileStart, 0, sizeof(int) * (size_t)(tileCount + 1));
+
+    // Count the commands in each tile.
+    int total = 0;
+    for (int i = 0; i < state->itemCount; i++) {
+        const pntr_nuklear_item* item = &state->items[i];
+        if (item->cmd->type == NK_COMMAND_CUSTOM || pntr_nuklear_rect_empty(item->bounds)) {
+            continue;
+        }
+        int x1 = item->bounds.x / PNTR_NUKLEAR_TILE_SIZE;
+        int y1 = item->bounds.y / PNTR_NUKLEAR_TILE_SIZE;
+        int x2 = (item->bounds.x + item->bounds.width - 1) / PNTR_NUKLEAR_TILE_SIZE;
+        int y2 = (item->bounds.y + item->bounds.height - 1) / PNTR_NUKLEAR_TILE_SIZE;
+        for (int y = y1; y <= y2; y++) {
+            for (int x = x1; x <= x2; x++) {
+                tileStart[y * columns + x + 1]++;
+                total++;
+            }
+        }
+    }
+
+    int* tileItems = (int*)pntr_nuklear_grow(state->tileItems, &state->tileItemsCapacity, total, sizeof(int));
+    if (tileItems == NULL) {
+        return false;
+    }
+    state->tileItems = tileItems;
+
+    for (int i = 0; i < tileCount; i++) {
+        tileStart[i + 1] += tileStart[i];
+    }
+
+    // Fill in the tiles, using the start of each tile as its write position.
+    for (int i = 0; i < state->itemCount; i++) {
+        const pntr_nuklear_item* item = &state->items[i];
+        if (item->cmd->type == NK_COMMAND_CUSTOM || pntr_nuklear_rect_empty(item->bounds)) {
+            continue;
+        }
+        int x1 = item->bounds.x / PNTR_NUKLEAR_TILE_SIZE;
+        int y1 = item->bounds.y / PNTR_NUKLEAR_TILE_SIZE;
+        int x2 = (item->bounds.x + item->bounds.width - 1) / PNTR_NUKLEAR_TILE_SIZE;
+        int y2 = (item->bounds.y + item->bounds.height - 1) / PNTR_NUKLEAR_TILE_SIZE;
+        for (int y = y1; y <= y2; y++) {
+            for (int x = x1; x <= x2; x++) {
+                tileItems[tileStart[y * columns + x]++] = i;
+            }
+        }
+    }
+
+    // Writing moved each start to the next tile's, so shift them back.
+    for (int i = tileCount; i > 0; i--) {
+        tileStart[i] = tileStart[i - 1];
+    }
+    tileStart[0] = 0;
+
+    return true;
+}
+
+/**
+ * Moves the given command by the given offset.
+ *
+ * @internal
+ */
+static void pntr_nuklear_translate_command(struct nk_command* cmd, int dx, int dy) {
+    #define PNTR_NUKLEAR_TRANSLATE(value, offset) (value) = (short)((value) + (offset))
+    #define PNTR_NUKLEAR_TRANSLATE_VEC(vec) PNTR_NUKLEAR_TRANSLATE((vec).x, dx); PNTR_NUKLEAR_TRANSLATE((vec).y, dy)
+    #define PNTR_NUKLEAR_TRANSLATE_XY(command) PNTR_NUKLEAR_TRANSLATE((command)->x, dx); PNTR_NUKLEAR_TRANSLATE((command)->y, dy)
+    switch (cmd->type) {
+        case NK_COMMAND_SCISSOR: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_scissor*)cmd); break;
+        case NK_COMMAND_RECT: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_rect*)cmd); break;
+        case NK_COMMAND_RECT_FILLED: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_rect_filled*)cmd); break;
+        case NK_COMMAND_RECT_MULTI_COLOR: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_rect_multi_color*)cmd); break;
+        case NK_COMMAND_CIRCLE: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_circle*)cmd); break;
+        case NK_COMMAND_CIRCLE_FILLED: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_circle_filled*)cmd); break;
+        case NK_COMMAND_IMAGE: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_image*)cmd); break;
+        case NK_COMMAND_CUSTOM: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_custom*)cmd); break;
+        case NK_COMMAND_TEXT: PNTR_NUKLEAR_TRANSLATE_XY((struct nk_command_text*)cmd); break;
+        case NK_COMMAND_LINE: {
+            struct nk_command_line *l = (struct nk_command_line*)cmd;
+            PNTR_NUKLEAR_TRANSLATE_VEC(l->begin);
+            PNTR_NUKLEAR_TRANSLATE_VEC(l->end);
+        } break;
+        case NK_COMMAND_CURVE: {
+            struct nk_command_curve *q = (struct nk_command_curve*)cmd;
+            PNTR_NUKLEAR_TRANSLATE_VEC(q->begin);
+            PNTR_NUKLEAR_TRANSLATE_VEC(q->ctrl[0]);
+            PNTR_NUKLEAR_TRANSLATE_VEC(q->ctrl[1]);
+            PNTR_NUKLEAR_TRANSLATE_VEC(q->end);
+        } break;
+        case NK_COMMAND_ARC: {
+            struct nk_command_arc *a = (struct nk_command_arc*)cmd;
+            PNTR_NUKLEAR_TRANSLATE(a->cx, dx);
+            PNTR_NUKLEAR_TRANSLATE(a->cy, dy);
+        } break;
+        case NK_COMMAND_ARC_FILLED: {
+            struct nk_command_arc_filled *a = (struct nk_command_arc_filled*)cmd;
+            PNTR_NUKLEAR_TRANSLATE(a->cx, dx);
+            PNTR_NUKLEAR_TRANSLATE(a->cy, dy);
+        } break;
+        case NK_COMMAND_TRIANGLE: {
+            struct nk_command_triangle *t = (struct nk_command_triangle*)cmd;
+            PNTR_NUKLEAR_TRANSLATE_VEC(t->a);
+            PNTR_NUKLEAR_TRANSLATE_VEC(t->b);
+            PNTR_NUKLEAR_TRANSLATE_VEC(t->c);
+        } break;
+        case NK_COMMAND_TRIANGLE_FILLED: {
+            struct nk_command_triangle_filled *t = (struct nk_command_triangle_filled*)cmd;
+            PNTR_NUKLEAR_TRANSLATE_VEC(t->a);
+            PNTR_NUKLEAR_TRANSLATE_VEC(t->b);
+            PNTR_NUKLEAR_TRANSLATE_VEC(t->c);
+        } break;
+        case NK_COMMAND_POLYGON: {
+            struct nk_command_polygon *p = (struct nk_command_polygon*)cmd;
+            for (int i = 0; i < p->point_count; i++) {
+                PNTR_NUKLEAR_TRANSLATE_VEC(p->points[i]);
+            }
+        } break;
+        case NK_COMMAND_POLYGON_FILLED: {
+            struct nk_command_polygon_filled *p = (struct nk_command_polygon_filled*)cmd;
+            for (int i = 0; i < p->point_count; i++) {
+                PNTR_NUKLEAR_TRANSLATE_VEC(p->points[i]);
+            }
+        } break;
+        case NK_COMMAND_POLYLINE: {
+            struct nk_command_polyline *p = (struct nk_command_polyline*)cmd;
+            for (int i = 0; i < p->point_count; i++) {
+                PNTR_NUKLEAR_TRANSLATE_VEC(p->points[i]);
+            }
+        } break;
+        default: break;
+    }
+    #undef PNTR_NUKLEAR_TRANSLATE_XY
+    #undef PNTR_NUKLEAR_TRANSLATE_VEC
+    #undef PNTR_NUKLEAR_TRANSLATE
+}
+
+/**
+ * Appends a copy of the given command to a command buffer, keeping commands aligned.
+ *
+ * @return The copied command, or NULL on failure. It is only valid until the next append.
+ *
+ * @internal
+ */
+static struct nk_command* pntr_nuklear_append_command(unsigned char** commands, int* capacity, int* size, const struct nk_command* cmd) {
+    const int align = (int)NK_ALIGNOF(struct nk_command);
+    int offset = (*size + align - 1) / align * align;
+    int commandSize = (int)pntr_nuklear_command_size(cmd);
+
+    unsigned char* buffer = (unsigned char*)pntr_nuklear_grow(*commands, capacity, offset + commandSize, 1);
+    if (buffer == NULL) {
+        return NULL;
+    }
+    *commands = buffer;
+
+    // Zero the alignment padding so that the buffer hashes the same each frame.
+    PNTR_MEMSET(buffer + *size, 0, (size_t)(offset - *size));
+    PNTR_MEMCPY(buffer + offset, cmd, (size_t)commandSize);
+    *size = offset + commandSize;
+    return (struct nk_command*)(buffer + offset);
+}
+
+/**
+ * Finds the window that wrote the given command, or NULL when it isn't part of a window.
+ *
+ * Popups are written in their parent window's buffer, so they belong to their parent.
+ *
+ * @internal
+ */
+static struct nk_window* pntr_nuklear_command_window(struct nk_context* ctx, const struct nk_command* cmd) {
+    nk_size offset = (nk_size)((const nk_byte*)cmd - (const nk_byte*)ctx->memory.memory.ptr);
+    for (struct nk_window* win = ctx->begin; win != NULL; win = win->next) {
+        if (offset >= win->buffer.begin && offset < win->buffer.end) {
+            return win;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Finds the cached layer for the given window that hasn't been used yet this frame, or creates one.
+ *
+ * A window that shows up more than once in a frame, like when it has an open popup, gets one layer for each.
+ *
+ * @internal
+ */
+static pntr_nuklear_layer* pntr_nuklear_get_layer(pntr_nuklear_context* state, nk_hash name) {
+    for (int i = 0; i < state->layerCount; i++) {
+        if (state->layers[i].name == name && !state->layers[i].used) {
+            return &state->layers[i];
+        }
+    }
+
+    pntr_nuklear_layer* layers = (pntr_nuklear_layer*)pntr_nuklear_grow(state->layers, &state->layerCapacity, state->layerCount + 1, sizeof(pntr_nuklear_layer));
+    if (layers == NULL) {
+        return NULL;
+    }
+    state->layers = layers;
+
+    pntr_nuklear_layer* layer = &state->layers[state->layerCount++];
+    PNTR_MEMSET(layer, 0, sizeof(pntr_nuklear_layer));
+    layer->name = name;
+    return layer;
+}
+
+/**
+ * Draws the given run of a window's commands through its cached layer.
+ *
+ * The commands are moved relative to the layer before being hashed, so a window that only moved reuses its
+ * pixels as they are.
+ *
+ * @return False when the commands need to be drawn directly, because the layer couldn't be made or isn't opaque.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_draw_layer(pntr_nuklear_context* state, pntr_image* dst, nk_hash name, int first, int last) {
+    // Find the area the window covers.
+    pntr_rectangle bounds = PNTR_CLITERAL(pntr_rectangle) { 0, 0, 0, 0 };
+    for (int i = first; i < last; i++) {
+        const pntr_nuklear_item* item = &state->items[i];
+        if (pntr_nuklear_rect_empty(item->bounds)) {
+            continue;
+        }
+        bounds = pntr_nuklear_rect_empty(bounds) ? item->bounds : pntr_nuklear_rect_union(bounds, item->bounds);
+    }
+    if (pntr_nuklear_rect_empty(bounds)) {
+        return true;
+    }
+
+    // Copy the commands relative to the layer, adding a scissor whenever the clip changes.
+    int size = 0;
+    pntr_rectangle clip = PNTR_CLITERAL(pntr_rectangle) { 0, 0, -1, -1 };
+    for (int i = first; i < last; i++) {
+        const pntr_nuklear_item* item = &state->items[i];
+        if (pntr_nuklear_rect_empty(item->bounds)) {
+            continue;
+        }
+
+        if (!pntr_nuklear_rect_equals(item->clip, clip)) {
+            struct nk_command_scissor scissor;
+            PNTR_MEMSET(&scissor, 0, sizeof(scissor));
+            scissor.header.type = NK_COMMAND_SCISSOR;
+            scissor.x = (short)item->clip.x;
+            scissor.y = (short)item->clip.y;
+            scissor.w = (unsigned short)item->clip.width;
+            scissor.h = (unsigned short)item->clip.height;
+            struct nk_command* copy = pntr_nuklear_append_command(&state->layerCommands, &state->layerCommandsCapacity, &size, &scissor.header);
+            if (copy == NULL) {
+                return false;
+            }
+            pntr_nuklear_translate_command(copy, -bounds.x, -bounds.y);
+            clip = item->clip;
+        }
+
+        struct nk_command* copy = pntr_nuklear_append_command(&state->layerCommands, &state->layerCommandsCapacity, &size, item->cmd);
+        if (copy == NULL) {
+            return false;
+        }
+        pntr_nuklear_translate_command(copy, -bounds.x, -bounds.y);
+    }
+
+    uint64_t hash = pntr_nuklear_hash(PNTR_NUKLEAR_HASH_SEED, state->layerCommands, (nk_size)size);
+    pntr_nuklear_layer* layer = pntr_nuklear_get_layer(state, name);
+    if (layer == NULL) {
+        return false;
+    }
+    layer->used = true;
+
+    // Compositing partly transparent pixels would apply their alpha a second time.
+    if (layer->rendered && layer->hash == hash && layer->translucent) {
+        return false;
+    }
+
+    if (layer->image == NULL || layer->image->width != bounds.width || layer->image->height != bounds.height) {
+        pntr_unload_image(layer->image);
+        layer->image = pntr_gen_image_color(bounds.width, bounds.height, pntr_new_color(0, 0, 0, 0));
+        layer->rendered = false;
+        if (layer->image == NULL) {
+            return false;
+        }
+    }
+
+    // Re-rasterize the layer only when its commands changed.
+    if (!layer->rendered || layer->hash != hash) {
+        pntr_nuklear_clear_rect(layer->image, PNTR_CLITERAL(pntr_rectangle) { 0, 0, bounds.width, bounds.height }, pntr_new_color(0, 0, 0, 0));
+        const int align = (int)NK_ALIGNOF(struct nk_command);
+        int offset = 0;
+        while (offset < size) {
+            const struct nk_command* cmd = (const struct nk_command*)(state->layerCommands + offset);
+            pntr_nuklear_draw_command(layer->image, cmd, state, 0);
+            offset = (offset + (int)pntr_nuklear_command_size(cmd) + align - 1) / align * align;
+        }
+        layer->hash = hash;
+        layer->rendered = true;
+
+        layer->translucent = false;
+        for (int y = 0; y < bounds.height && !layer->translucent; y++) {
+            const pntr_color* row = layer->image->data + y * (layer->image->pitch >> 2);
+            for (int x = 0; x < bounds.width; x++) {
+                if (row[x].rgba.a > 0 && row[x].rgba.a < 255) {
+                    layer->translucent = true;
+                    break;
+                }
+            }
+        }
+        if (layer->translucent) {
+            return false;
+        }
+    }
+
+    pntr_draw_image(dst, layer->image, bounds.x, bounds.y);
+    return true;
+}
+
+/**
+ * Checks whether Nuklear ran out of memory while building the frame, leaving its commands incomplete.
+ *
+ * This only happens with the fixed block of memory given to pntr_load_nuklear_fixed().
+ *
+ * @internal
+ */
+static bool pntr_nuklear_out_of_memory(struct nk_context* ctx) {
+    // Nuklear counts what failed allocations needed, along with what it did allocate from either end.
+    const struct nk_buffer* memory = &ctx->memory;
+    return memory->needed > memory->allocated + (memory->memory.size - memory->size);
+}
+
+/**
+ * Finishes drawing the frame, and lets Nuklear process events for the next one.
+ *
+ * @internal
+ */
+static void pntr_nuklear_end_frame(struct nk_context* ctx) {
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    state->memoryUsed = ctx->memory.needed;
+    nk_clear(ctx);
+
+    // Fixed blocks keep counting what failed allocations needed, so start the next frame from what is allocated.
+    if (!ctx->use_pool) {
+        ctx->memory.needed = ctx->memory.allocated + (ctx->memory.memory.size - ctx->memory.size);
+    }
+
+    // Size the command buffer for the busiest recent frame, so that the next ones don't have to grow it.
+    if (ctx->memory.type == NK_BUFFER_DYNAMIC) {
+        state->memoryHistory[state->memoryFrame] = state->memoryUsed;
+        state->memoryFrame = (state->memoryFrame + 1) % state->allocator.historyFrames;
+        nk_size highWaterMark = 0;
+        for (int i = 0; i < state->allocator.historyFrames; i++) {
+            highWaterMark = PNTR_NUKLEAR_MAX(highWaterMark, state->memoryHistory[i]);
+        }
+
+        nk_size step = state->allocator.growStep;
+        nk_size size = PNTR_NUKLEAR_MAX((highWaterMark + step - 1) / step, 1) * step;
+        if (ctx->memory.memory.size < size) {
+            pntr_nuklear_resize_memory(ctx, size);
+            state->memoryIdleFrames = 0;
+        }
+        else if (ctx->memory.memory.size > size && state->allocator.shrinkAfter > 0) {
+            if (++state->memoryIdleFrames >= state->allocator.shrinkAfter) {
+                pntr_nuklear_resize_memory(ctx, size);
+                state->memoryIdleFrames = 0;
+            }
+        }
+        else {
+            state->memoryIdleFrames = 0;
+        }
+    }
+
+    // Let Nuklear know that it may now process events.
+    nk_input_begin(ctx);
+}
+
+/**
+ * Draws a context set up with Nuklear's own nk_init functions, which has none of pntr_nuklear's state.
+ *
+ * Each command is drawn in order with a blank state that is thrown away afterwards, so nothing is kept between
+ * frames, and images are resampled directly rather than cached.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_draw_stateless(pntr_image* dst, struct nk_context* ctx) {
+    nk_input_end(ctx);
+
+    pntr_nuklear_context* state = (pntr_nuklear_context*)pntr_load_memory(sizeof(pntr_nuklear_context));
+    if (state != NULL) {
+        PNTR_MEMSET(state, 0, sizeof(pntr_nuklear_context));
+        state->curveTolerance = PNTR_NUKLEAR_CURVE_TOLERANCE;
+        state->imageCacheLocked = true;
+
+        pntr_rectangle clip = dst->clip;
+        const struct nk_command *cmd;
+        nk_foreach(cmd, ctx) {
+            pntr_nuklear_draw_command(dst, cmd, state, 0);
+        }
+        pntr_image_set_clip(dst, clip.x, clip.y, clip.width, clip.height);
+
+        pntr_unload_memory(state->scratch[0].memory);
+        pntr_unload_memory(state);
+    }
+
+    nk_clear(ctx);
+    nk_input_begin(ctx);
+    return state != NULL;
+}
+
+PNTR_NUKLEAR_API bool pntr_draw_nuklear(pntr_image* dst, struct nk_context* ctx) {
+    if (dst == NULL || ctx == NULL) {
+        return false;
+    }
+
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    if (state == NULL) {
+        return pntr_nuklear_draw_stateless(dst, ctx);
+    }
+    pntr_nuklear_wait(ctx);
+
+    // Finish processing events as we'll now draw the context.
+    nk_input_end(ctx);
+
+    // Leave the image as is rather than drawing part of the frame.
+    if (pntr_nuklear_out_of_memory(ctx)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
+
+    // Skip the frame when it is the same as the last one drawn.
+    if (pntr_nuklear_skip_frame(state, dst)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
+
+    if (!pntr_nuklear_collect(state, dst, false)) {
+        // Out of memory, so iterate through each drawing command instead.
+        const struct nk_command *cmd;
+        nk_foreach(cmd, ctx) {
+            pntr_nuklear_draw_command(dst, cmd, state, 0);
+        }
+    }
+    else {
+        // Skip what would be painted over, and draw the rest with their clip.
+        pntr_nuklear_cull(state);
+        pntr_rectangle clip = dst->clip;
+        pntr_rectangle current = clip;
+        for (int i = 0; i < state->itemCount; i++) {
+            const pntr_nuklear_item* item = &state->items[i];
+            if (!pntr_nuklear_rect_equals(item->clip, current)) {
+                current = item->clip;
+                pntr_image_set_clip(dst, current.x, current.y, current.width, current.height);
+            }
+            pntr_nuklear_draw_command(dst, item->cmd, state, 0);
+        }
+        pntr_image_set_clip(dst, clip.x, clip.y, clip.width, clip.height);
+    }
+
+    // The incremental renderer can no longer rely on what is in the image.
+    state->invalidated = true;
+
+    pntr_nuklear_end_frame(ctx);
+
+    return true;
+}
+
+/**
+ * What the jobs of pntr_draw_nuklear_batch() draw.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_batch {
+    pntr_image** images;
+    struct nk_context** contexts;
+    bool* drawn;
+} pntr_nuklear_batch;
+
+/**
+ * Draws one context of a batch.
+ *
+ * @internal
+ */
+static void pntr_nuklear_draw_batch_item(void* data, int index, int worker) {
+    NK_UNUSED(worker);
+    pntr_nuklear_batch* batch = (pntr_nuklear_batch*)data;
+    batch->drawn[index] = pntr_draw_nuklear(batch->images[index], batch->contexts[index]);
+}
+
+PNTR_NUKLEAR_API int pntr_draw_nuklear_batch(pntr_image** images, struct nk_context** contexts, int count, int threads) {
+    if (images == NULL || contexts == NULL || count <= 0) {
+        return 0;
+    }
+
+    bool* drawn = (bool*)pntr_load_memory(sizeof(bool) * (size_t)count);
+    if (drawn == NULL) {
+        return 0;
+    }
+
+    pntr_nuklear_batch batch;
+    batch.images = images;
+    batch.contexts = contexts;
+    batch.drawn = drawn;
+    pntr_nuklear_run_jobs(pntr_nuklear_draw_batch_item, &batch, count, threads);
+
+    int output = 0;
+    for (int i = 0; i < count; i++) {
+        if (drawn[i]) {
+            output++;
+        }
+    }
+
+    pntr_unload_memory(drawn);
+    return output;
+}
+
+/**
+ * Copies the frame's commands into the frame packet, leaving out what wouldn't be drawn.
+ *
+ * @return True on success, false when out of memory.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_snapshot_frame(pntr_nuklear_context* state, pntr_image* dst) {
+    state->frameCommandsSize = 0;
+    if (!pntr_nuklear_collect(state, dst, false)) {
+        return false;
+    }
+    pntr_nuklear_cull(state);
+
+    // Add a scissor whenever the clip changes, as the commands are drawn without their items.
+    pntr_rectangle clip = dst->clip;
+    for (int i = 0; i < state->itemCount; i++) {
+        const pntr_nuklear_item* item = &state->items[i];
+        if (!pntr_nuklear_rect_equals(item->clip, clip)) {
+            struct nk_command_scissor scissor;
+            PNTR_MEMSET(&scissor, 0, sizeof(scissor));
+            scissor.header.type = NK_COMMAND_SCISSOR;
+            scissor.x = (short)item->clip.x;
+            scissor.y = (short)item->clip.y;
+            scissor.w = (unsigned short)item->clip.width;
+            scissor.h = (unsigned short)item->clip.height;
+            if (pntr_nuklear_append_command(&state->frameCommands, &state->frameCommandsCapacity, &state->frameCommandsSize, &scissor.header) == NULL) {
+                return false;
+            }
+            clip = item->clip;
+        }
+
+        if (pntr_nuklear_append_command(&state->frameCommands, &state->frameCommandsCapacity, &state->frameCommandsSize, item->cmd) == NULL) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Draws the commands in the frame packet.
+ *
+ * @internal
+ */
+static void pntr_nuklear_draw_frame(pntr_nuklear_context* state) {
+    pntr_image* dst = state->frameDst;
+    pntr_rectangle clip = dst->clip;
+    const int align = (int)NK_ALIGNOF(struct nk_command);
+    int offset = 0;
+    while (offset < state->frameCommandsSize) {
+        const struct nk_command* cmd = (const struct nk_command*)(state->frameCommands + offset);
+        pntr_nuklear_draw_command(dst, cmd, state, 0);
+        offset = (offset + (int)pntr_nuklear_command_size(cmd) + align - 1) / align * align;
+    }
+    pntr_image_set_clip(dst, clip.x, clip.y, clip.width, clip.height);
+}
+
+#ifdef PNTR_NUKLEAR_ENABLE_THREADS
+/**
+ * The context's render thread, which draws each frame packet it is woken up for.
+ *
+ * @internal
+ */
+static void* pntr_nuklear_frame_thread(void* data) {
+    pntr_nuklear_context* state = (pntr_nuklear_context*)data;
+    pthread_mutex_lock(&state->frameMutex);
+    for (;;) {
+        while (!state->frameDrawing && !state->frameQuit) {
+            pthread_cond_wait(&state->frameWake, &state->frameMutex);
+        }
+        if (!state->frameDrawing) {
+            break;
+        }
+
+        pthread_mutex_unlock(&state->frameMutex);
+        pntr_nuklear_draw_frame(state);
+        pthread_mutex_lock(&state->frameMutex);
+        state->frameDrawing = false;
+        pthread_cond_broadcast(&state->frameDone);
+    }
+    pthread_mutex_unlock(&state->frameMutex);
+    return NULL;
+}
+
+/**
+ * Starts the context's render thread, unless it is already running.
+ *
+ * @return True when the render thread is running, false when it couldn't be started.
+ *
+ * @internal
+ */
+static bool pntr_nuklear_start_frame_thread(pntr_nuklear_context* state) {
+    if (state->frameThreadStarted) {
+        return true;
+    }
+
+    if (pthread_mutex_init(&state->frameMutex, NULL) != 0) {
+        return false;
+    }
+    if (pthread_cond_init(&state->frameWake, NULL) != 0) {
+        pthread_mutex_destroy(&state->frameMutex);
+        return false;
+    }
+    if (pthread_cond_init(&state->frameDone, NULL) != 0) {
+        pthread_cond_destroy(&state->frameWake);
+        pthread_mutex_destroy(&state->frameMutex);
+        return false;
+    }
+
+    state->frameQuit = false;
+    if (pthread_create(&state->frameThread, NULL, pntr_nuklear_frame_thread, state) != 0) {
+        pthread_cond_destroy(&state->frameDone);
+        pthread_cond_destroy(&state->frameWake);
+        pthread_mutex_destroy(&state->frameMutex);
+        return false;
+    }
+
+    state->frameThreadStarted = true;
+    return true;
+}
+
+#endif
+
+PNTR_NUKLEAR_API void pntr_nuklear_wait(struct nk_context* ctx) {
+    if (ctx == NULL) {
+        return;
+    }
+
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    if (state == NULL) {
+        return;
+    }
+
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        if (state->frameThreadStarted) {
+            pthread_mutex_lock(&state->frameMutex);
+            while (state->frameDrawing) {
+                pthread_cond_wait(&state->frameDone, &state->frameMutex);
+            }
+            pthread_mutex_unlock(&state->frameMutex);
+        }
+    #endif
+}
+
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_async(pntr_image* dst, struct nk_context* ctx) {
+    if (dst == NULL || ctx == NULL) {
+        return false;
+    }
+
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    if (state == NULL) {
+        return pntr_nuklear_draw_stateless(dst, ctx);
+    }
+    pntr_nuklear_wait(ctx);
+
+    // Finish processing events as we'll now draw the context.
+    nk_input_end(ctx);
+
+    // Leave the image as is rather than drawing part of the frame.
+    if (pntr_nuklear_out_of_memory(ctx)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
+
+    // The incremental renderer can no longer rely on what is in the image.
+    state->invalidated = true;
+    state->frameTarget = NULL;
+
+    if (!pntr_nuklear_snapshot_frame(state, dst)) {
+        // Out of memory, so draw the frame here instead.
+        const struct nk_command *cmd;
+        nk_foreach(cmd, ctx) {
+            pntr_nuklear_draw_command(dst, cmd, state, 0);
+        }
+        pntr_image_set_clip(dst, 0, 0, dst->width, dst->height);
+        pntr_nuklear_end_frame(ctx);
+        return true;
+    }
+
+    // The frame packet no longer needs Nuklear's commands, so the next frame may be built.
+    pntr_nuklear_end_frame(ctx);
+
+    state->frameDst = dst;
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        if (pntr_nuklear_start_frame_thread(state)) {
+            pthread_mutex_lock(&state->frameMutex);
+            state->frameDrawing = true;
+            pthread_cond_signal(&state->frameWake);
+            pthread_mutex_unlock(&state->frameMutex);
+            return true;
+        }
+    #endif
+
+    pntr_nuklear_draw_frame(state);
+    return true;
+}
+
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_tiled(pntr_image* dst, struct nk_context* ctx, int threads) {
+    if (dst == NULL || ctx == NULL) {
+        return false;
+    }
+
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    if (state == NULL) {
+        return pntr_nuklear_draw_stateless(dst, ctx);
+    }
+    pntr_nuklear_wait(ctx);
+
+    // Finish processing events as we'll now draw the context.
+    nk_input_end(ctx);
+
+    // Leave the image as is rather than drawing part of the frame.
+    if (pntr_nuklear_out_of_memory(ctx)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
+
+    if (pntr_nuklear_skip_frame(state, dst)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
+
+    int columns = (dst->width + PNTR_NUKLEAR_TILE_SIZE - 1) / PNTR_NUKLEAR_TILE_SIZE;
+    int rows = (dst->height + PNTR_NUKLEAR_TILE_SIZE - 1) / PNTR_NUKLEAR_TILE_SIZE;
+    bool collected = pntr_nuklear_collect(state, dst, false);
+    if (collected) {
+        pntr_nuklear_cull(state);
+    }
+    if (!collected || !pntr_nuklear_bin_tiles(state, columns, rows)) {
+        // Out of memory, so draw everything on this thread instead.
+        const struct nk_command *cmd;
+        nk_foreach(cmd, ctx) {
+            pntr_nuklear_draw_command(dst, cmd, state, 0);
+        }
+    }
+    else {
+        pntr_nuklear_tiles tiles;
+        tiles.state = state;
+        tiles.dst = dst;
+        tiles.columns = columns;
+
+        // Rescale images up front, so that the threads only read the image cache.
+        pntr_nuklear_prepare_images(state);
+
+        // Custom commands run on the calling thread, so the tiles are drawn up to each one, keeping the order.
+        for (tiles.first = 0; tiles.first < state->itemCount; tiles.first = tiles.last + 1) {
+            tiles.last = pntr_nuklear_next_custom(state, tiles.first);
+            if (tiles.last > tiles.first) {
+                state->imageCacheLocked = true;
+                pntr_nuklear_run_jobs(pntr_nuklear_draw_tile, &tiles, columns * rows, threads);
+                state->imageCacheLocked = false;
+            }
+            if (tiles.last < state->itemCount) {
+                pntr_nuklear_draw_custom(dst, &state->items[tiles.last], state);
+            }
+        }
+    }
+
+    // The incremental renderer can no longer rely on what is in the image.
+    state->invalidated = true;
+
+    pntr_nuklear_end_frame(ctx);
+
+    return true;
+}
+
+/**
+ * What the band jobs of pntr_draw_nuklear_parallel() draw.
+ *
+ * @internal
+ */
+typedef struct pntr_nuklear_bands {
+    pntr_nuklear_context* state;
+    pntr_image* dst;
+    int height;
+    int first;  // The first collected command to draw.
+    int last;   // One past the last collected command to draw.
+} pntr_nuklear_bands;
+
+/**
+ * Draws the commands from `first` to `last` touching one band, clipped to the band.
+ *
+ * Bands are never more than the scratch buffers, so each band uses its own.
+ *
+ * @internal
+ */
+static void pntr_nuklear_draw_band(void* data, int index) {
+    pntr_nuklear_bands* bands = (pntr_nuklear_bands*)data;
+    pntr_nuklear_context* state = bands->state;
+
+    // Each band gets its own view of the image, so that the clip isn't shared between threads.
+    pntr_image target = *bands->dst;
+    pntr_rectangle band = pntr_nuklear_rect_intersect(
+        PNTR_CLITERAL(pntr_rectangle) { 0, index * bands->height, target.width, bands->height },
+        PNTR_CLITERAL(pntr_rectangle) { 0, 0, target.width, target.height }
+    );
 
-#ifndef PNTR_NUKLEAR_DOUBLE_CLICK_TIME
-#define PNTR_NUKLEAR_DOUBLE_CLICK_TIME 0.3f
-#endif
-#endif
+    for (int i = bands->first; i < bands->last; i++) {
+        const pntr_nuklear_item* item = &state->items[i];
+        if (!pntr_nuklear_rect_overlaps(item->bounds, band)) {
+            continue;
+        }
+        pntr_rectangle clip = pntr_nuklear_rect_intersect(item->clip, band);
+        pntr_image_set_clip(&target, clip.x, clip.y, clip.width, clip.height);
+        pntr_nuklear_draw_command(&target, item->cmd, state, index);
+    }
+}
 
-PNTR_NUKLEAR_API struct nk_context* pntr_load_nuklear(pntr_font* font) {
-    if (font == NULL) {
-        return NULL;
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_parallel(pntr_image* dst, struct nk_context* ctx, pntr_nuklear_parallel_for parallelFor, void* user) {
+    if (dst == NULL || ctx == NULL) {
+        return false;
     }
 
-    // Build the memory.
-    struct nk_context* ctx = (struct nk_context*)pntr_load_memory(sizeof(struct nk_context));
-    struct nk_user_font* userFont = (struct nk_user_font*)pntr_load_memory(sizeof(struct nk_user_font));
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    if (state == NULL) {
+        return pntr_nuklear_draw_stateless(dst, ctx);
+    }
+    pntr_nuklear_wait(ctx);
 
-    // Allocator
-    struct nk_allocator allocator;
-    allocator.alloc = pntr_nuklear_alloc;
-    allocator.free = pntr_nuklear_free;
+    // Finish processing events as we'll now draw the context.
+    nk_input_end(ctx);
 
-    // Set up the font, and find the tallest character.
-    #define PNTR_LOAD_NUKLEAR_ALPHABET_START (33)
-    #define PNTR_LOAD_NUKLEAR_ALPHABET_LEN (172 - PNTR_LOAD_NUKLEAR_ALPHABET_START)
-    char theAlphabet[PNTR_LOAD_NUKLEAR_ALPHABET_LEN + 1];
-    for (int i = 0; i < PNTR_LOAD_NUKLEAR_ALPHABET_LEN; i++) {
-        theAlphabet[i] = (char)(i + PNTR_LOAD_NUKLEAR_ALPHABET_START);
+    // Leave the image as is rather than drawing part of the frame.
+    if (pntr_nuklear_out_of_memory(ctx)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
     }
-    theAlphabet[PNTR_LOAD_NUKLEAR_ALPHABET_LEN] = '\0';
 
-    pntr_vector size = pntr_measure_text_ex(font, theAlphabet, PNTR_LOAD_NUKLEAR_ALPHABET_LEN);
-    userFont->height = (float)size.y;
-    userFont->width = _pntr_nuklear_text_width;
-    userFont->userdata.ptr = font;
+    if (pntr_nuklear_skip_frame(state, dst)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
 
-    // Create the nuklear environment.
-    if (nk_init(ctx, &allocator, userFont) == 0) {
-        pntr_unload_memory(userFont);
-        pntr_unload_memory(ctx);
-        return NULL;
+    if (!pntr_nuklear_collect(state, dst, false)) {
+        // Out of memory, so draw everything on this thread instead.
+        const struct nk_command *cmd;
+        nk_foreach(cmd, ctx) {
+            pntr_nuklear_draw_command(dst, cmd, state, 0);
+        }
     }
+    else {
+        pntr_nuklear_cull(state);
 
-    // Let Nuklear know that it may now process events.
-    nk_input_begin(ctx);
+        // There is scratch memory for each band.
+        int count = PNTR_NUKLEAR_MIN((dst->height + PNTR_NUKLEAR_BAND_HEIGHT - 1) / PNTR_NUKLEAR_BAND_HEIGHT, PNTR_NUKLEAR_MAX_THREADS);
+        count = PNTR_NUKLEAR_MAX(count, 1);
+        pntr_nuklear_bands bands;
+        bands.state = state;
+        bands.dst = dst;
+        bands.height = (dst->height + count - 1) / count;
 
-    return ctx;
-}
+        // Rescale images up front, so that the bands only read the image cache.
+        pntr_nuklear_prepare_images(state);
 
-PNTR_NUKLEAR_API void pntr_unload_nuklear(struct nk_context* ctx) {
-    // Skip unloading if it's not set.
-    if (ctx == NULL) {
-        return;
+        // Custom commands run on the calling thread, so the bands are drawn up to each one, keeping the order.
+        for (bands.first = 0; bands.first < state->itemCount; bands.first = bands.last + 1) {
+            bands.last = pntr_nuklear_next_custom(state, bands.first);
+            if (bands.last > bands.first) {
+                state->imageCacheLocked = true;
+                if (parallelFor != NULL) {
+                    parallelFor(user, count, pntr_nuklear_draw_band, &bands);
+                }
+                else {
+                    for (int i = 0; i < count; i++) {
+                        pntr_nuklear_draw_band(&bands, i);
+                    }
+                }
+                state->imageCacheLocked = false;
+            }
+            if (bands.last < state->itemCount) {
+                pntr_nuklear_draw_custom(dst, &state->items[bands.last], state);
+            }
+        }
     }
 
-    // Clear up anything remaining from the context.
-    nk_input_end(ctx);
-    nk_clear(ctx);
-
-    // Clear the user font.
-    pntr_unload_memory((void*)ctx->style.font);
-    ctx->style.font = NULL;
+    // The incremental renderer can no longer rely on what is in the image.
+    state->invalidated = true;
 
-    // Unload the nuklear context.
-    nk_free(ctx);
+    pntr_nuklear_end_frame(ctx);
 
-    // Unload the memory
-    pntr_unload_memory(ctx);
+    return true;
 }
 
-PNTR_NUKLEAR_API void pntr_nuklear_update(struct nk_context* ctx, PNTR_APP_TYPE* app) {
-    if (ctx == NULL || app == NULL) {
-        return;
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_layered(pntr_image* dst, struct nk_context* ctx) {
+    if (dst == NULL || ctx == NULL) {
+        return false;
     }
 
-    #ifndef PNTR_APP_API
-        return;
-    #else
-        // Set up the clipboard if needed.
-        if (ctx->clip.userdata.ptr == NULL) {
-            ctx->clip.userdata.ptr = app;
-            ctx->clip.copy = pntr_nuklear_clipboard_copy;
-            ctx->clip.paste = pntr_nuklear_clipboard_paste;
-        }
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    if (state == NULL) {
+        return pntr_nuklear_draw_stateless(dst, ctx);
+    }
+    pntr_nuklear_wait(ctx);
 
-        // Delta Time
-        ctx->delta_time_seconds = pntr_app_delta_time(app);
+    // Finish processing events as we'll now draw the context.
+    nk_input_end(ctx);
 
-        // Keyboard
-        bool shift = pntr_app_key_down(app, PNTR_APP_KEY_LEFT_SHIFT) || pntr_app_key_down(app, PNTR_APP_KEY_RIGHT_SHIFT);
-        bool control = pntr_app_key_down(app, PNTR_APP_KEY_LEFT_CONTROL) || pntr_app_key_down(app, PNTR_APP_KEY_RIGHT_CONTROL);
-        nk_input_key(ctx, NK_KEY_ALT, pntr_app_key_down(app, PNTR_APP_KEY_LEFT_ALT) || pntr_app_key_down(app, PNTR_APP_KEY_RIGHT_ALT));
-        nk_input_key(ctx, NK_KEY_SHIFT, shift);
-        nk_input_key(ctx, NK_KEY_CTRL, control);
-        nk_input_key(ctx, NK_KEY_DEL, pntr_app_key_down(app, PNTR_APP_KEY_DELETE));
-        nk_input_key(ctx, NK_KEY_ENTER, pntr_app_key_down(app, PNTR_APP_KEY_ENTER) || pntr_app_key_down(app, PNTR_APP_KEY_KP_ENTER));
-        nk_input_key(ctx, NK_KEY_TAB, pntr_app_key_down(app, PNTR_APP_KEY_TAB));
-        nk_input_key(ctx, NK_KEY_BACKSPACE, pntr_app_key_down(app, PNTR_APP_KEY_BACKSPACE));
-        nk_input_key(ctx, NK_KEY_COPY, control && pntr_app_key_pressed(app, PNTR_APP_KEY_C));
-        nk_input_key(ctx, NK_KEY_CUT, control && pntr_app_key_pressed(app, PNTR_APP_KEY_X));
-        nk_input_key(ctx, NK_KEY_PASTE, control && pntr_app_key_pressed(app, PNTR_APP_KEY_V));
-        nk_input_key(ctx, NK_KEY_UP, pntr_app_key_down(app, PNTR_APP_KEY_UP));
-        nk_input_key(ctx, NK_KEY_DOWN, pntr_app_key_down(app, PNTR_APP_KEY_DOWN));
-        nk_input_key(ctx, NK_KEY_LEFT, pntr_app_key_down(app, PNTR_APP_KEY_LEFT));
-        nk_input_key(ctx, NK_KEY_RIGHT, pntr_app_key_down(app, PNTR_APP_KEY_RIGHT));
-        //nk_input_key(ctx, NK_KEY_TEXT_INSERT_MODE, pntr_app_key_down(app, PNTR_APP_KEY_ENTER));
-        //nk_input_key(ctx, NK_KEY_TEXT_REPLACE_MODE, pntr_app_key_down(app, PNTR_APP_KEY_ESCAPE));
-        nk_input_key(ctx, NK_KEY_TEXT_RESET_MODE, pntr_app_key_down(app, PNTR_APP_KEY_ESCAPE));
-        nk_input_key(ctx, NK_KEY_TEXT_LINE_START, !control && pntr_app_key_down(app, PNTR_APP_KEY_HOME));
-        nk_input_key(ctx, NK_KEY_TEXT_LINE_END, !control && pntr_app_key_down(app, PNTR_APP_KEY_END));
-        nk_input_key(ctx, NK_KEY_TEXT_START, control && pntr_app_key_down(app, PNTR_APP_KEY_HOME));
-        nk_input_key(ctx, NK_KEY_TEXT_END, control && pntr_app_key_down(app, PNTR_APP_KEY_END));
-        nk_input_key(ctx, NK_KEY_TEXT_UNDO, control && pntr_app_key_down(app, PNTR_APP_KEY_Z));
-        nk_input_key(ctx, NK_KEY_TEXT_REDO, control && pntr_app_key_down(app, PNTR_APP_KEY_Y));
-        nk_input_key(ctx, NK_KEY_TEXT_SELECT_ALL, control && pntr_app_key_down(app, PNTR_APP_KEY_A));
-        nk_input_key(ctx, NK_KEY_TEXT_WORD_LEFT, control && pntr_app_key_down(app, PNTR_APP_KEY_LEFT));
-        nk_input_key(ctx, NK_KEY_TEXT_WORD_RIGHT, control && pntr_app_key_down(app, PNTR_APP_KEY_RIGHT));
-        nk_input_key(ctx, NK_KEY_SCROLL_START, control && pntr_app_key_down(app, PNTR_APP_KEY_PAGE_UP));
-        nk_input_key(ctx, NK_KEY_SCROLL_END, control && pntr_app_key_down(app, PNTR_APP_KEY_PAGE_DOWN));
-        nk_input_key(ctx, NK_KEY_SCROLL_DOWN, pntr_app_key_down(app, PNTR_APP_KEY_PAGE_DOWN));
-        nk_input_key(ctx, NK_KEY_SCROLL_UP, pntr_app_key_down(app, PNTR_APP_KEY_PAGE_UP));
+    // Leave the image as is rather than drawing part of the frame.
+    if (pntr_nuklear_out_of_memory(ctx)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
 
-        nk_input_key(ctx, NK_KEY_F1, pntr_app_key_down(app, PNTR_APP_KEY_F1));
-        nk_input_key(ctx, NK_KEY_F2, pntr_app_key_down(app, PNTR_APP_KEY_F2));
-        nk_input_key(ctx, NK_KEY_F3, pntr_app_key_down(app, PNTR_APP_KEY_F3));
-        nk_input_key(ctx, NK_KEY_F4, pntr_app_key_down(app, PNTR_APP_KEY_F4));
-        nk_input_key(ctx, NK_KEY_F5, pntr_app_key_down(app, PNTR_APP_KEY_F5));
-        nk_input_key(ctx, NK_KEY_F6, pntr_app_key_down(app, PNTR_APP_KEY_F6));
-        nk_input_key(ctx, NK_KEY_F7, pntr_app_key_down(app, PNTR_APP_KEY_F7));
-        nk_input_key(ctx, NK_KEY_F8, pntr_app_key_down(app, PNTR_APP_KEY_F8));
-        nk_input_key(ctx, NK_KEY_F9, pntr_app_key_down(app, PNTR_APP_KEY_F9));
-        nk_input_key(ctx, NK_KEY_F10, pntr_app_key_down(app, PNTR_APP_KEY_F10));
-        nk_input_key(ctx, NK_KEY_F11, pntr_app_key_down(app, PNTR_APP_KEY_F11));
-        nk_input_key(ctx, NK_KEY_F12, pntr_app_key_down(app, PNTR_APP_KEY_F12));
+    if (pntr_nuklear_skip_frame(state, dst)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
 
-        // Keyboard text input. Translation is layout-aware when
-        // PNTR_NUKLEAR_KEY_CHAR is overridden; otherwise falls back to US QWERTY.
-        if (!control) {
-            for (int k = PNTR_APP_KEY_FIRST; k < PNTR_APP_KEY_LAST; k++) {
-                if (pntr_app_key_pressed(app, (pntr_app_key)k)) {
-                    char c = PNTR_NUKLEAR_KEY_CHAR(app, (pntr_app_key)k, shift);
-                    if (c != 0) {
-                        nk_input_char(ctx, c);
+    pntr_rectangle clip = dst->clip;
+    if (!pntr_nuklear_collect(state, dst, false)) {
+        // Out of memory, so draw everything directly instead.
+        const struct nk_command *cmd;
+        nk_foreach(cmd, ctx) {
+            pntr_nuklear_draw_command(dst, cmd, state, 0);
+        }
+    }
+    else {
+        for (int i = 0; i < state->layerCount; i++) {
+            state->layers[i].used = false;
+        }
+
+        // Composite each run of commands from the same window through its layer, in z-order.
+        int first = 0;
+        while (first < state->itemCount) {
+            struct nk_window* win = pntr_nuklear_command_window(ctx, state->items[first].cmd);
+            int last = first + 1;
+            while (last < state->itemCount && pntr_nuklear_command_window(ctx, state->items[last].cmd) == win) {
+                last++;
+            }
+
+            // Custom commands draw through their own data rather than on the layer, so their window is drawn directly.
+            bool custom = pntr_nuklear_next_custom(state, first) < last;
+            if (win == NULL || custom || !pntr_nuklear_draw_layer(state, dst, win->name, first, last)) {
+                // Commands outside of a window, or a layer that couldn't be made, are drawn directly.
+                for (int i = first; i < last; i++) {
+                    const pntr_nuklear_item* item = &state->items[i];
+                    if (item->cmd->type == NK_COMMAND_CUSTOM) {
+                        pntr_nuklear_draw_custom(dst, item, state);
+                        continue;
                     }
+                    if (pntr_nuklear_rect_empty(item->bounds)) {
+                        continue;
+                    }
+                    pntr_image_set_clip(dst, item->clip.x, item->clip.y, item->clip.width, item->clip.height);
+                    pntr_nuklear_draw_command(dst, item->cmd, state, 0);
                 }
+                pntr_image_set_clip(dst, clip.x, clip.y, clip.width, clip.height);
             }
-        }
 
-        // Mouse
-        int mouseX = pntr_app_mouse_x(app);
-        int mouseY = pntr_app_mouse_y(app);
-        nk_input_motion(ctx, mouseX, mouseY);
-        nk_input_scroll(ctx, nk_vec2(0.0f, pntr_app_mouse_wheel(app)));
-        nk_input_button(ctx, NK_BUTTON_LEFT, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_LEFT));
-        nk_input_button(ctx, NK_BUTTON_MIDDLE, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_MIDDLE));
-        nk_input_button(ctx, NK_BUTTON_RIGHT, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_RIGHT));
-        nk_input_button(ctx, NK_BUTTON_X1, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_X1));
-        nk_input_button(ctx, NK_BUTTON_X2, mouseX, mouseY, pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_X2));
+            first = last;
+        }
 
-        // Double Click
-        {
-            static float dclick_timer = 1.0f;
-            dclick_timer += pntr_app_delta_time(app);
-            if (pntr_app_mouse_button_pressed(app, PNTR_APP_MOUSE_BUTTON_LEFT)) {
-                if (dclick_timer < PNTR_NUKLEAR_DOUBLE_CLICK_TIME) {
-                    nk_input_button(ctx, NK_BUTTON_DOUBLE, mouseX, mouseY, nk_true);
-                    dclick_timer = 1.0f;
-                } else {
-                    dclick_timer = 0.0f;
-                }
+        // Free the layers of windows that are no longer shown.
+        int count = 0;
+        for (int i = 0; i < state->layerCount; i++) {
+            if (state->layers[i].used) {
+                state->layers[count++] = state->layers[i];
             }
-            if (!pntr_app_mouse_button_down(app, PNTR_APP_MOUSE_BUTTON_LEFT)) {
-                nk_input_button(ctx, NK_BUTTON_DOUBLE, mouseX, mouseY, nk_false);
+            else {
+                pntr_unload_image(state->layers[i].image);
             }
         }
-    #endif
-}
+        state->layerCount = count;
+    }
 
-/**
- * Maximum number of vertices for polygon and polyline commands.
- * Define before including pntr_nuklear.h to raise the limit, e.g.:
- *   #define PNTR_NUKLEAR_MAX_POLYGON_POINTS 128
- * Debug builds will assert when a polygon exceeds this limit.
- */
-#ifndef PNTR_NUKLEAR_MAX_POLYGON_POINTS
-#define PNTR_NUKLEAR_MAX_POLYGON_POINTS 64
-#endif
+    pntr_image_set_clip(dst, clip.x, clip.y, clip.width, clip.height);
 
-/**
- * Draw a filled polygon using Nuklear values.
- *
- * @see nk_rawfb_fill_polygon()
- * @see https://github.com/Immediate-Mode-UI/Nuklear/blob/master/demo/rawfb/nuklear_rawfb.h
- *
- * @internal
- */
-PNTR_NUKLEAR_API void pntr_nuklear_draw_polygon_fill(pntr_image* dst, const struct nk_vec2i *pnts, int count, pntr_color col) {
-    if (count == 0) return;
-    NK_ASSERT(count <= PNTR_NUKLEAR_MAX_POLYGON_POINTS);
-    if (count > PNTR_NUKLEAR_MAX_POLYGON_POINTS)
-        count = PNTR_NUKLEAR_MAX_POLYGON_POINTS;
-    pntr_vector points[PNTR_NUKLEAR_MAX_POLYGON_POINTS];
-    for (int i = 0; i < count; i++) {
-        points[i].x = pnts[i].x;
-        points[i].y = pnts[i].y;
-    }
-    pntr_draw_polygon_fill(dst, points, count, col);
+    // The incremental renderer can no longer rely on what is in the image.
+    state->invalidated = true;
+
+    pntr_nuklear_end_frame(ctx);
+
+    return true;
 }
 
-PNTR_NUKLEAR_API void pntr_draw_nuklear(pntr_image* dst, struct nk_context* ctx) {
+PNTR_NUKLEAR_API bool pntr_draw_nuklear_incremental(pntr_image* dst, struct nk_context* ctx, pntr_color background) {
     if (dst == NULL || ctx == NULL) {
-        return;
+        return false;
+    }
+
+    // Without the last frame to compare against, redraw everything.
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    if (state == NULL) {
+        pntr_clear_background(dst, background);
+        return pntr_nuklear_draw_stateless(dst, ctx);
     }
+    pntr_nuklear_wait(ctx);
 
     // Finish processing events as we'll now draw the context.
     nk_input_end(ctx);
 
-    // Iterate through each drawing command.
-    const struct nk_command *cmd;
+    // Leave the image as is rather than drawing part of the frame.
+    if (pntr_nuklear_out_of_memory(ctx)) {
+        pntr_nuklear_end_frame(ctx);
+        return false;
+    }
 
-    nk_foreach(cmd, ctx) {
-        switch (cmd->type) {
-            case NK_COMMAND_NOP: {
-                break;
+    pntr_rectangle clip = dst->clip;
+    pntr_rectangle screen = PNTR_CLITERAL(pntr_rectangle) { 0, 0, dst->width, dst->height };
+    if (!pntr_nuklear_collect(state, dst, true)) {
+        // Out of memory, so fall back to redrawing everything.
+        const struct nk_command *cmd;
+        pntr_clear_background(dst, background);
+        nk_foreach(cmd, ctx) {
+            pntr_nuklear_draw_command(dst, cmd, state, 0);
+        }
+        pntr_image_set_clip(dst, clip.x, clip.y, clip.width, clip.height);
+        state->invalidated = true;
+        state->frameTarget = NULL;
+        pntr_nuklear_end_frame(ctx);
+        return true;
+    }
+
+    // Find what changed since the last frame.
+    state->damageCount = 0;
+    if (state->invalidated || state->target != dst || state->targetWidth != dst->width || state->targetHeight != dst->height) {
+        pntr_nuklear_add_damage(state, screen);
+    }
+    else {
+        pntr_nuklear_compute_damage(state);
+    }
+
+    // Redraw the damaged areas, clipping each command to them.
+    for (int d = 0; d < state->damageCount; d++) {
+        pntr_rectangle damage = pntr_nuklear_rect_intersect(state->damage[d], screen);
+        pntr_nuklear_clear_rect(dst, damage, background);
+        for (int i = 0; i < state->itemCount; i++) {
+            const pntr_nuklear_item* item = &state->items[i];
+            if (item->cmd->type == NK_COMMAND_CUSTOM || !pntr_nuklear_rect_overlaps(item->bounds, damage)) {
+                continue;
             }
 
-            case NK_COMMAND_SCISSOR: {
-                const struct nk_command_scissor *s =(const struct nk_command_scissor*)cmd;
-                pntr_image_set_clip(dst, s->x, s->y, s->w, s->h);
-            } break;
-
-            case NK_COMMAND_LINE: {
-                const struct nk_command_line *l = (const struct nk_command_line *)cmd;
-                pntr_draw_line_thick(dst,
-                    l->begin.x, l->begin.y,
-                    l->end.x, l->end.y,
-                    (int)l->line_thickness,
-                    pntr_nk_color_to_color(l->color)
-                );
-            } break;
-
-            case NK_COMMAND_CURVE: {
-                const struct nk_command_curve *q = (const struct nk_command_curve *)cmd;
-                #ifndef PNTR_NUKLEAR_CURVE_SEGMENTS
-                    #define PNTR_NUKLEAR_CURVE_SEGMENTS 22
-                #endif
-                pntr_draw_line_curve_thick(dst,
-                    pntr_nk_vec2i_to_vector(q->begin),
-                    pntr_nk_vec2i_to_vector(q->ctrl[0]),
-                    pntr_nk_vec2i_to_vector(q->ctrl[1]),
-                    pntr_nk_vec2i_to_vector(q->end),
-                    PNTR_NUKLEAR_CURVE_SEGMENTS,
-                    (int)q->line_thickness,
-                    pntr_nk_color_to_color(q->color)
-                );
-            } break;
-
-            case NK_COMMAND_RECT: {
-                const struct nk_command_rect *r = (const struct nk_command_rect *)cmd;
-                pntr_color color = pntr_nk_color_to_color(r->color);
-                int rounding = (int)r->rounding;
-                pntr_draw_rectangle_thick_rounded(dst,
-                    (int)r->x, (int)r->y,
-                    (int)r->w, (int)r->h,
-                    rounding, rounding, rounding, rounding,
-                    (int)r->line_thickness,
-                    color
-                );
-            } break;
-
-            case NK_COMMAND_RECT_FILLED: {
-                const struct nk_command_rect_filled *r = (const struct nk_command_rect_filled *)cmd;
-                pntr_draw_rectangle_rounded_fill(dst, (int)r->x, (int)r->y, (int)r->w, (int)r->h, (int)r->rounding, pntr_nk_color_to_color(r->color));
-            } break;
-
-            case NK_COMMAND_RECT_MULTI_COLOR: {
-                const struct nk_command_rect_multi_color* rectangle = (const struct nk_command_rect_multi_color *)cmd;
-                pntr_draw_rectangle_gradient_rec(dst,
-                    PNTR_CLITERAL(pntr_rectangle) {(int)rectangle->x, (int)rectangle->y, (int)rectangle->w, (int)rectangle->h},
-                    pntr_nk_color_to_color(rectangle->left),
-                    pntr_nk_color_to_color(rectangle->top),
-                    pntr_nk_color_to_color(rectangle->bottom),
-                    pntr_nk_color_to_color(rectangle->right)
-                );
-            } break;
-
-            case NK_COMMAND_CIRCLE: {
-                const struct nk_command_circle *c = (const struct nk_command_circle *)cmd;
-                pntr_color color = pntr_nk_color_to_color(c->color);
-                if (c->w == c->h) {
-                    pntr_draw_circle_thick(dst, c->x + c->w / 2, c->y + c->h / 2, c->w / 2 + 1, (int)c->line_thickness, color);
-                }
-                else {
-                    pntr_draw_ellipse_thick(dst, c->x + c->w / 2, c->y + c->h / 2, c->w / 2 + 1, c->h / 2 + 1, (int)c->line_thickness, color);
-                }
-            } break;
+            pntr_rectangle itemClip = pntr_nuklear_rect_intersect(item->clip, damage);
+            pntr_image_set_clip(dst, itemClip.x, itemClip.y, itemClip.width, itemClip.height);
+            pntr_nuklear_draw_command(dst, item->cmd, state, 0);
+        }
+    }
 
-            case NK_COMMAND_CIRCLE_FILLED: {
-                const struct nk_command_circle_filled *c = (const struct nk_command_circle_filled *)cmd;
-                pntr_color color = pntr_nk_color_to_color(c->color);
-                if (c->w == c->h) {
-                    pntr_draw_circle_fill(dst, c->x + c->w / 2, c->y + c->h / 2, c->w / 2 + 1, color);
-                }
-                else {
-                    pntr_draw_ellipse_fill(dst, c->x + c->w / 2, c->y + c->h / 2, c->w / 2 + 1, c->h / 2 + 1, color);
-                }
-            } break;
-
-            case NK_COMMAND_ARC: {
-                const struct nk_command_arc *a = (const struct nk_command_arc*)cmd;
-                float startAngle = a->a[0] * 180.0f / PNTR_PI;
-                float endAngle = a->a[1] * 180.0f / PNTR_PI;
-                pntr_draw_arc_thick(dst, a->cx, a->cy, a->r, startAngle, endAngle, a->r * 3, (int)a->line_thickness, pntr_nk_color_to_color(a->color));
-            } break;
-
-            case NK_COMMAND_ARC_FILLED: {
-                const struct nk_command_arc_filled *a = (const struct nk_command_arc_filled*)cmd;
-                pntr_color color = pntr_nk_color_to_color(a->color);
-
-                float startAngle = a->a[0] * 180.0f / PNTR_PI;
-                float endAngle = a->a[1] * 180.0f / PNTR_PI;
-
-                pntr_draw_arc_fill(dst, (int)a->cx, (int)a->cy, a->r, startAngle, endAngle, a->r * 2, color);
-            } break;
-
-            case NK_COMMAND_TRIANGLE: {
-                const struct nk_command_triangle *t = (const struct nk_command_triangle*)cmd;
-                pntr_color color = pntr_nk_color_to_color(t->color);
-                pntr_draw_triangle_thick(dst, t->b.x, t->b.y, t->a.x, t->a.y, t->c.x, t->c.y, (int)t->line_thickness, color);
-            } break;
-
-            case NK_COMMAND_TRIANGLE_FILLED: {
-                const struct nk_command_triangle_filled *t = (const struct nk_command_triangle_filled*)cmd;
-                pntr_color color = pntr_nk_color_to_color(t->color);
-                pntr_draw_triangle_fill(dst, t->b.x, t->b.y, t->a.x, t->a.y, t->c.x, t->c.y, color);
-            } break;
-
-            case NK_COMMAND_POLYGON: {
-                const struct nk_command_polygon *p = (const struct nk_command_polygon*)cmd;
-                pntr_color color = pntr_nk_color_to_color(p->color);
-                NK_ASSERT(p->point_count <= PNTR_NUKLEAR_MAX_POLYGON_POINTS);
-                int count = (p->point_count < PNTR_NUKLEAR_MAX_POLYGON_POINTS) ? p->point_count : PNTR_NUKLEAR_MAX_POLYGON_POINTS;
-                pntr_vector points[PNTR_NUKLEAR_MAX_POLYGON_POINTS];
-                for (int i = 0; i < count; i++) {
-                    points[i].x = p->points[i].x;
-                    points[i].y = p->points[i].y;
-                }
-                pntr_draw_polygon_thick(dst, points, count, (int)p->line_thickness, color);
-            } break;
-
-            case NK_COMMAND_POLYGON_FILLED: {
-                const struct nk_command_polygon_filled *p = (const struct nk_command_polygon_filled*)cmd;
-                pntr_color color = pntr_nk_color_to_color(p->color);
-                NK_ASSERT(p->point_count <= PNTR_NUKLEAR_MAX_POLYGON_POINTS);
-                int count = (p->point_count < PNTR_NUKLEAR_MAX_POLYGON_POINTS) ? p->point_count : PNTR_NUKLEAR_MAX_POLYGON_POINTS;
-                pntr_vector points[PNTR_NUKLEAR_MAX_POLYGON_POINTS];
-                for (int i = 0; i < count; i++) {
-                    points[i].x = p->points[i].x;
-                    points[i].y = p->points[i].y;
-                }
-                pntr_draw_polygon_fill(dst, points, count, color);
-            } break;
-
-            case NK_COMMAND_POLYLINE: {
-                const struct nk_command_polyline *p = (const struct nk_command_polyline *)cmd;
-                pntr_color color = pntr_nk_color_to_color(p->color);
-                NK_ASSERT(p->point_count <= PNTR_NUKLEAR_MAX_POLYGON_POINTS);
-                int count = (p->point_count < PNTR_NUKLEAR_MAX_POLYGON_POINTS) ? p->point_count : PNTR_NUKLEAR_MAX_POLYGON_POINTS;
-                pntr_vector points[PNTR_NUKLEAR_MAX_POLYGON_POINTS];
-                for (int i = 0; i < count; i++) {
-                    points[i].x = p->points[i].x;
-                    points[i].y = p->points[i].y;
-                }
-                pntr_draw_polyline_thick(dst, points, count, (int)p->line_thickness, color);
-            } break;
-
-            case NK_COMMAND_TEXT: {
-                const struct nk_command_text *text = (const struct nk_command_text*)cmd;
-                // Don't draw the text background by default.
-                #ifdef PNTR_NUKLEAR_DRAW_TEXT_BACKGROUND
-                if (text->background.a > 0) {
-                    pntr_draw_rectangle_fill(dst, text->x, text->y, text->w, text->h, pntr_nk_color_to_color(text->background));
-                }
-                #endif
-                pntr_font* font = (pntr_font*)text->font->userdata.ptr;
-                pntr_draw_text(dst, font, (const char*)text->string, text->x, text->y, pntr_nk_color_to_color(text->foreground));
-            } break;
-
-            case NK_COMMAND_IMAGE: {
-                const struct nk_command_image *i = (const struct nk_command_image *)cmd;
-                if (i == NULL) {
-                    break;
-                }
+    // Custom commands run once, no matter the damage.
+    for (int i = 0; i < state->itemCount; i++) {
+        if (state->items[i].cmd->type == NK_COMMAND_CUSTOM) {
+            pntr_nuklear_draw_command(dst, state->items[i].cmd, state, 0);
+        }
+    }
 
-                pntr_image* image = (pntr_image*)(i->img.handle.ptr);
-                if (image == NULL) {
-                    break;
-                }
+    pntr_image_set_clip(dst, clip.x, clip.y, clip.width, clip.height);
 
-                pntr_color tint = pntr_nk_color_to_color(i->col);
-                pntr_rectangle srcRect = {
-                    .x = i->img.region[0],
-                    .y = i->img.region[1],
-                    .width = i->img.region[2],
-                    .height = i->img.region[3]
-                };
-                pntr_draw_image_scaled_rec(dst, image, srcRect, i->x, i->y, (float)i->w / (float)srcRect.width, (float)i->h / (float)srcRect.height, 0, 0, PNTR_FILTER_BILINEAR, tint);
-            } break;
+    // Keep this frame's commands to compare against the next one.
+    pntr_nuklear_item* items = state->previous;
+    int capacity = state->previousCapacity;
+    state->previous = state->items;
+    state->previousCount = state->itemCount;
+    state->previousCapacity = state->itemCapacity;
+    state->items = items;
+    state->itemCount = 0;
+    state->itemCapacity = capacity;
+    state->target = dst;
+    state->targetWidth = dst->width;
+    state->targetHeight = dst->height;
+    state->invalidated = false;
+    state->frameTarget = NULL;
 
-            case NK_COMMAND_CUSTOM: {
-                const struct nk_command_custom *custom = (const struct nk_command_custom *)cmd;
-                custom->callback(NULL, (short)(custom->x), (short)(custom->y), (unsigned short)(custom->w), (unsigned short)(custom->h), custom->callback_data);
-            } break;
+    pntr_nuklear_end_frame(ctx);
 
-            default: {
-                //TraceLog(LOG_WARNING, "NUKLEAR: Missing implementation %i", cmd->type);
-            } break;
-        }
+    return state->damageCount > 0;
+}
+
+PNTR_NUKLEAR_API nk_size pntr_nuklear_get_memory_used(struct nk_context* ctx) {
+    if (ctx == NULL) {
+        return 0;
     }
 
-    nk_clear(ctx);
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    return (state == NULL) ? 0 : state->memoryUsed;
+}
 
-    // Let Nuklear know that it may now process events.
-    nk_input_begin(ctx);
+PNTR_NUKLEAR_API void pntr_nuklear_invalidate(struct nk_context* ctx) {
+    if (ctx == NULL || pntr_nuklear_get_context(ctx) == NULL) {
+        return;
+    }
+
+    // The render thread may still be using the image cache.
+    pntr_nuklear_wait(ctx);
+
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    pntr_nuklear_redraw(state);
+
+    // Images drawn may have changed their pixels.
+    pntr_nuklear_clear_image_cache(state);
+}
+
+PNTR_NUKLEAR_API void pntr_nuklear_invalidate_image(struct nk_context* ctx, pntr_image* image) {
+    if (ctx == NULL || image == NULL || pntr_nuklear_get_context(ctx) == NULL) {
+        return;
+    }
+
+    // The render thread may still be using the image cache.
+    pntr_nuklear_wait(ctx);
+
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    pntr_nuklear_redraw(state);
+    pntr_nuklear_uncache_image(state, image);
+}
+
+PNTR_NUKLEAR_API void pntr_nuklear_set_skip_unchanged(struct nk_context* ctx, bool skip) {
+    if (ctx == NULL || pntr_nuklear_get_context(ctx) == NULL) {
+        return;
+    }
+
+    // The render thread may still be drawing the last frame.
+    pntr_nuklear_wait(ctx);
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    state->skipUnchanged = skip;
+    state->frameTarget = NULL;
+}
+
+PNTR_NUKLEAR_API void pntr_nuklear_set_font(struct nk_context* ctx, pntr_font* font) {
+    if (ctx == NULL || font == NULL || pntr_nuklear_get_context(ctx) == NULL) {
+        return;
+    }
+
+    // Measure the new font, keeping the counters.
+    pntr_nuklear_wait(ctx);
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    unsigned int hits = state->font.cacheHits;
+    unsigned int misses = state->font.cacheMisses;
+    pntr_nuklear_font_unload(&state->font);
+    pntr_nuklear_font_init(&state->font, font);
+    state->font.cacheHits = hits;
+    state->font.cacheMisses = misses;
+    nk_style_set_font(ctx, &state->font.userFont);
+
+    // Text commands point to the same nk_user_font, so cached pixels can't tell the fonts apart.
+    pntr_nuklear_invalidate(ctx);
+}
+
+PNTR_NUKLEAR_API void pntr_nuklear_set_curve_tolerance(struct nk_context* ctx, float tolerance) {
+    if (ctx == NULL || !(tolerance > 0.0f) || pntr_nuklear_get_context(ctx) == NULL) {
+        return;
+    }
+
+    pntr_nuklear_wait(ctx);
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    state->curveTolerance = tolerance;
+
+    // The same commands now draw differently.
+    pntr_nuklear_invalidate(ctx);
+}
+
+PNTR_NUKLEAR_API pntr_nuklear_stats pntr_nuklear_get_stats(struct nk_context* ctx) {
+    pntr_nuklear_stats stats;
+    PNTR_MEMSET(&stats, 0, sizeof(stats));
+    if (ctx == NULL || pntr_nuklear_get_context(ctx) == NULL) {
+        return stats;
+    }
+
+    // The render thread may still be counting.
+    pntr_nuklear_wait(ctx);
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    stats = state->stats;
+    stats.textCacheHits = state->font.cacheHits;
+    stats.textCacheMisses = state->font.cacheMisses;
+    return stats;
+}
+
+PNTR_NUKLEAR_API void pntr_nuklear_reset_stats(struct nk_context* ctx) {
+    if (ctx == NULL || pntr_nuklear_get_context(ctx) == NULL) {
+        return;
+    }
+
+    // The render thread may still be counting.
+    pntr_nuklear_wait(ctx);
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    PNTR_MEMSET(&state->stats, 0, sizeof(state->stats));
+    state->font.cacheHits = 0;
+    state->font.cacheMisses = 0;
+}
+
+PNTR_NUKLEAR_API pntr_nuklear_memory_stats pntr_nuklear_get_memory_stats(struct nk_context* ctx) {
+    pntr_nuklear_memory_stats stats;
+    PNTR_MEMSET(&stats, 0, sizeof(stats));
+    if (ctx == NULL) {
+        return stats;
+    }
+
+    // Only Nuklear's own counters are known for contexts without state.
+    pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+    if (state != NULL) {
+        stats = state->memoryStats;
+        stats.commandBufferUsed = state->memoryUsed;
+    }
+    stats.commandBufferSize = ctx->memory.memory.size;
+    stats.windowCount = ctx->count;
+
+    // Page elements are handed out from the newest page, and reused from the free list.
+    if (ctx->use_pool) {
+        for (const struct nk_page* page = ctx->pool.pages; page != NULL; page = page->next) {
+            stats.pageElementsUsed += page->size;
+            stats.pageElementsAllocated += ctx->pool.capacity;
+        }
+        for (const struct nk_page_element* element = ctx->freelist; element != NULL; element = element->next) {
+            stats.pageElementsUsed--;
+        }
+    }
+
+    return stats;
 }
 
 PNTR_NUKLEAR_API inline struct nk_rect pntr_rectangle_to_nk_rect(pntr_rectangle rectangle) {
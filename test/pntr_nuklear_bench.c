@@ -0,0 +1,240 @@
+// clock_gettime() is POSIX rather than C99.
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+    #define _DEFAULT_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h> // INT_MAX, used by overview.c
+#include <time.h>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#endif
+
+#define PNTR_ENABLE_DEFAULT_FONT
+#define PNTR_ENABLE_MATH
+#define PNTR_IMPLEMENTATION
+#include "pntr.h"
+
+#define PNTR_NUKLEAR_IMPLEMENTATION
+#include "pntr_nuklear.h"
+
+// Include the demo UIs
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wconversion"
+#pragma GCC diagnostic ignored "-Wfloat-conversion"
+#pragma GCC diagnostic ignored "-Wimplicit-function-declaration"
+#pragma GCC diagnostic ignored "-Wsign-conversion"
+#pragma GCC diagnostic ignored "-Wincompatible-pointer-types"
+#pragma GCC diagnostic ignored "-Wunused-parameter"
+#pragma GCC diagnostic ignored "-Wunused-function"
+#include "../examples/demo/common/style.c"
+#include "../examples/demo/common/calculator.c"
+#include "../examples/demo/common/canvas.c"
+#include "../examples/demo/common/overview.c"
+#include "../examples/demo/common/node_editor.c"
+#pragma GCC diagnostic pop
+
+#define BENCH_WIDTH 1280
+#define BENCH_HEIGHT 800
+#define BENCH_DEFAULT_FRAMES 300
+#define BENCH_COMMAND_TYPES (NK_COMMAND_CUSTOM + 1)
+
+static const char* command_names[BENCH_COMMAND_TYPES] = {
+    "nop", "scissor", "line", "curve", "rect", "rect_filled", "rect_multi_color", "circle", "circle_filled",
+    "arc", "arc_filled", "triangle", "triangle_filled", "polygon", "polygon_filled", "polyline", "text", "image",
+    "custom"
+};
+
+typedef struct bench_scene {
+    const char* name;
+    void (*build)(struct nk_context* ctx);
+    enum theme theme;
+} bench_scene;
+
+static void build_overview(struct nk_context* ctx) {
+    overview(ctx);
+}
+
+static void build_calculator(struct nk_context* ctx) {
+    calculator(ctx);
+}
+
+static void build_canvas(struct nk_context* ctx) {
+    canvas(ctx);
+}
+
+static void build_node_editor(struct nk_context* ctx) {
+    node_editor(ctx);
+}
+
+static void build_all(struct nk_context* ctx) {
+    calculator(ctx);
+    canvas(ctx);
+    overview(ctx);
+    node_editor(ctx);
+}
+
+static const bench_scene scenes[] = {
+    { "overview", build_overview, THEME_BLACK },
+    { "calculator", build_calculator, THEME_BLACK },
+    { "canvas", build_canvas, THEME_BLACK },
+    { "style", build_all, THEME_DRACULA },
+    { "node_editor", build_node_editor, THEME_BLACK },
+};
+
+/**
+ * Reads a monotonic wall clock, so that the time spent waiting on the system isn't left out.
+ */
+static double seconds(void) {
+    #ifdef _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (double)counter.QuadPart / (double)frequency.QuadPart;
+    #else
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (double)now.tv_sec + (double)now.tv_nsec / 1000000000.0;
+    #endif
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Prints the fastest, median and slowest of the given frame times, in milliseconds.
+ */
+static void print_times(double* values, int count) {
+    qsort(values, (size_t)count, sizeof(double), compare_doubles);
+    double median = (count % 2 == 1) ? values[count / 2] : (values[count / 2 - 1] + values[count / 2]) * 0.5;
+    printf("%8.3f ms min, %8.3f ms median, %8.3f ms max\n", values[0] * 1000.0, median * 1000.0, values[count - 1] * 1000.0);
+}
+
+/**
+ * Moves the mouse around in a circle, clicking every so often, the same way each run.
+ */
+static void script_input(struct nk_context* ctx, int frame) {
+    int x = BENCH_WIDTH / 2 + (int)(300.0f * PNTR_COSF((float)frame * 0.05f));
+    int y = BENCH_HEIGHT / 2 + (int)(250.0f * PNTR_SINF((float)frame * 0.05f));
+    nk_input_motion(ctx, x, y);
+    nk_input_button(ctx, NK_BUTTON_LEFT, x, y, frame % 30 == 0);
+    nk_input_scroll(ctx, nk_vec2(0.0f, (frame % 60 == 15) ? -1.0f : 0.0f));
+}
+
+/**
+ * Draws only the commands of one type, along with the scissors, so that each type's cost can be timed alone.
+ */
+static void draw_command_type(pntr_image* dst, struct nk_context* ctx, enum nk_command_type type, int* count) {
+    const struct nk_command* cmd;
+    nk_foreach(cmd, ctx) {
+        if (cmd->type == NK_COMMAND_SCISSOR || cmd->type == type) {
+            pntr_nuklear_draw_command(dst, cmd, pntr_nuklear_get_context(ctx), 0);
+        }
+        if (cmd->type == type) {
+            (*count)++;
+        }
+    }
+    pntr_image_set_clip(dst, 0, 0, dst->width, dst->height);
+}
+
+static void run_scene(const bench_scene* scene, pntr_font* font, int frames) {
+    struct nk_context* ctx = pntr_load_nuklear(font);
+    pntr_image* screen = pntr_gen_image_color(BENCH_WIDTH, BENCH_HEIGHT, PNTR_BLACK);
+    pntr_image* scratch = pntr_gen_image_color(BENCH_WIDTH, BENCH_HEIGHT, PNTR_BLACK);
+    double* buildTimes = (double*)malloc(sizeof(double) * (size_t)frames);
+    double* drawTimes = (double*)malloc(sizeof(double) * (size_t)frames);
+    double* typeTimes = (double*)calloc((size_t)frames * BENCH_COMMAND_TYPES, sizeof(double));
+    if (ctx == NULL || screen == NULL || scratch == NULL || buildTimes == NULL || drawTimes == NULL || typeTimes == NULL) {
+        fprintf(stderr, "%s: out of memory\n", scene->name);
+        exit(1);
+    }
+    set_style(ctx, scene->theme);
+
+    int typeCounts[BENCH_COMMAND_TYPES] = { 0 };
+    double commands = 0.0;
+    double pixels = 0.0;
+
+    for (int frame = 0; frame < frames; frame++) {
+        script_input(ctx, frame);
+
+        double start = seconds();
+        scene->build(ctx);
+        buildTimes[frame] = seconds() - start;
+
+        // Time each command type on its own, before the frame is drawn and cleared.
+        for (int type = NK_COMMAND_LINE; type < BENCH_COMMAND_TYPES; type++) {
+            start = seconds();
+            draw_command_type(scratch, ctx, (enum nk_command_type)type, &typeCounts[type]);
+            typeTimes[type * frames + frame] = seconds() - start;
+        }
+
+        pntr_clear_background(screen, PNTR_BLACK);
+        start = seconds();
+        pntr_draw_nuklear(screen, ctx);
+        drawTimes[frame] = seconds() - start;
+
+        // The collected commands are kept until the next frame.
+        pntr_nuklear_context* state = pntr_nuklear_get_context(ctx);
+        commands += state->itemCount;
+        for (int i = 0; i < state->itemCount; i++) {
+            pntr_rectangle area = pntr_nuklear_rect_intersect(state->items[i].bounds, state->items[i].clip);
+            if (!pntr_nuklear_rect_empty(area)) {
+                pixels += (double)area.width * (double)area.height;
+            }
+        }
+    }
+
+    pntr_nuklear_stats stats = pntr_nuklear_get_stats(ctx);
+    printf("%s: %d frames\n", scene->name, frames);
+    printf("  build             ");
+    print_times(buildTimes, frames);
+    printf("  pntr_draw_nuklear ");
+    print_times(drawTimes, frames);
+    printf("  commands         %9.1f per frame, %.0f pixels touched per frame\n", commands / frames, pixels / frames);
+    printf("  dropped %u, culled %u\n", stats.droppedCommands, stats.culledCommands);
+    for (int type = NK_COMMAND_LINE; type < BENCH_COMMAND_TYPES; type++) {
+        if (typeCounts[type] > 0) {
+            printf("  %-16s %9.1f per frame, ", command_names[type], (double)typeCounts[type] / frames);
+            print_times(&typeTimes[type * frames], frames);
+        }
+    }
+
+    free(buildTimes);
+    free(drawTimes);
+    free(typeTimes);
+    pntr_unload_image(scratch);
+    pntr_unload_image(screen);
+    pntr_unload_nuklear(ctx);
+}
+
+int main(int argc, char* argv[]) {
+    int frames = (argc > 1) ? atoi(argv[1]) : BENCH_DEFAULT_FRAMES;
+    if (frames < 1) {
+        fprintf(stderr, "Usage: %s [frames] [scene]\n", argv[0]);
+        return 1;
+    }
+
+    pntr_font* font = pntr_load_font_default();
+    if (font == NULL) {
+        fprintf(stderr, "Failed to load the default font\n");
+        return 1;
+    }
+
+    for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++) {
+        if (argc > 2 && strcmp(argv[2], scenes[i].name) != 0) {
+            continue;
+        }
+        run_scene(&scenes[i], font, frames);
+    }
+
+    pntr_unload_font(font);
+    return 0;
+}
@@ -0,0 +1,307 @@
+// clock_gettime() is POSIX rather than C99.
+#if !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+    #define _DEFAULT_SOURCE
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef _WIN32
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#endif
+
+#define PNTR_ENABLE_DEFAULT_FONT
+#define PNTR_ENABLE_MATH
+#define PNTR_IMPLEMENTATION
+#include "pntr.h"
+
+#define PNTR_NUKLEAR_IMPLEMENTATION
+#include "pntr_nuklear.h"
+
+#define PERF_WIDTH 1280
+#define PERF_HEIGHT 800
+#define PERF_WARMUP_FRAMES 5
+#define PERF_FRAMES 60
+#define PERF_DEFAULT_TOLERANCE 0.25
+#define PERF_POLYLINE_POINTS 2000
+
+static const char* lorem = "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do eiusmod tempor incididunt ut labore "
+    "et dolore magna aliqua. Ut enim ad minim veniam, quis nostrud exercitation ullamco laboris nisi ut aliquip ex ea "
+    "commodo consequat. Duis aute irure dolor in reprehenderit in voluptate velit esse cillum dolore eu fugiat nulla "
+    "pariatur. Excepteur sint occaecat cupidatat non proident, sunt in culpa qui officia deserunt mollit anim id est laborum.";
+
+typedef struct perf_scene {
+    const char* name;
+    void (*build)(struct nk_context* ctx, pntr_image* image);
+} perf_scene;
+
+/**
+ * A grid of small windows, each with a handful of widgets.
+ */
+static void build_windows(struct nk_context* ctx, pntr_image* image) {
+    (void)image;
+    char title[32];
+    for (int i = 0; i < 48; i++) {
+        float x = (float)(i % 8) * 158.0f + 6.0f;
+        float y = (float)(i / 8) * 132.0f + 6.0f;
+        snprintf(title, sizeof(title), "Window %d", i);
+        if (nk_begin(ctx, title, nk_rect(x, y, 150, 126), NK_WINDOW_BORDER|NK_WINDOW_TITLE|NK_WINDOW_NO_SCROLLBAR)) {
+            nk_layout_row_dynamic(ctx, 20, 2);
+            nk_label(ctx, "Label", NK_TEXT_LEFT);
+            nk_button_label(ctx, "Button");
+            nk_layout_row_dynamic(ctx, 20, 1);
+            nk_progress(ctx, &(nk_size){ (nk_size)(i * 2) }, 100, nk_false);
+            nk_check_label(ctx, "Check", i % 2);
+        }
+        nk_end(ctx);
+    }
+}
+
+/**
+ * One large window full of long, wrapped text.
+ */
+static void build_text(struct nk_context* ctx, pntr_image* image) {
+    (void)image;
+    if (nk_begin(ctx, "Text", nk_rect(10, 10, PERF_WIDTH - 20, PERF_HEIGHT - 20), NK_WINDOW_BORDER|NK_WINDOW_TITLE)) {
+        for (int i = 0; i < 16; i++) {
+            nk_layout_row_dynamic(ctx, 40, 1);
+            nk_label_wrap(ctx, lorem);
+            nk_layout_row_dynamic(ctx, 16, 2);
+            nk_label(ctx, lorem, NK_TEXT_LEFT);
+            nk_label(ctx, lorem + i * 7, NK_TEXT_RIGHT);
+        }
+    }
+    nk_end(ctx);
+}
+
+/**
+ * Long thin and thick polylines drawn straight to the window canvas.
+ */
+static void build_polylines(struct nk_context* ctx, pntr_image* image) {
+    (void)image;
+    static float points[PERF_POLYLINE_POINTS * 2];
+    if (nk_begin(ctx, "Polylines", nk_rect(10, 10, PERF_WIDTH - 20, PERF_HEIGHT - 20), NK_WINDOW_BORDER|NK_WINDOW_NO_SCROLLBAR)) {
+        struct nk_command_buffer* canvas = nk_window_get_canvas(ctx);
+        for (int line = 0; line < 8; line++) {
+            float baseline = 60.0f + (float)line * 90.0f;
+            for (int i = 0; i < PERF_POLYLINE_POINTS; i++) {
+                float x = 20.0f + (float)i * (float)(PERF_WIDTH - 60) / (float)PERF_POLYLINE_POINTS;
+                points[i * 2] = x;
+                points[i * 2 + 1] = baseline + 35.0f * PNTR_SINF(x * 0.01f * (float)(line + 1));
+            }
+            nk_stroke_polyline(canvas, points, PERF_POLYLINE_POINTS, (float)(line % 3 + 1), nk_rgb(255 - line * 30, 100 + line * 20, 200));
+        }
+    }
+    nk_end(ctx);
+}
+
+/**
+ * A grid of image widgets, most of which need to be scaled.
+ */
+static void build_images(struct nk_context* ctx, pntr_image* image) {
+    struct nk_image img = pntr_image_nk(image);
+    if (nk_begin(ctx, "Images", nk_rect(10, 10, PERF_WIDTH - 20, PERF_HEIGHT - 20), NK_WINDOW_BORDER|NK_WINDOW_NO_SCROLLBAR)) {
+        for (int row = 0; row < 12; row++) {
+            float size = (float)(24 + (row % 4) * 16);
+            nk_layout_row_static(ctx, size, (int)size, 16);
+            for (int i = 0; i < 16; i++) {
+                nk_image(ctx, img);
+            }
+        }
+    }
+    nk_end(ctx);
+}
+
+static const perf_scene scenes[] = {
+    { "windows", build_windows },
+    { "text", build_text },
+    { "polylines", build_polylines },
+    { "images", build_images },
+};
+
+/**
+ * Reads a monotonic wall clock, so that frames are timed the same however the threads are scheduled.
+ */
+static double seconds(void) {
+    #ifdef _WIN32
+        LARGE_INTEGER frequency, counter;
+        QueryPerformanceFrequency(&frequency);
+        QueryPerformanceCounter(&counter);
+        return (double)counter.QuadPart / (double)frequency.QuadPart;
+    #else
+        struct timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        return (double)now.tv_sec + (double)now.tv_nsec / 1000000000.0;
+    #endif
+}
+
+static int compare_doubles(const void* a, const void* b) {
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+    return (x > y) - (x < y);
+}
+
+static bool images_equal(pntr_image* a, pntr_image* b) {
+    if (a->width != b->width || a->height != b->height) {
+        return false;
+    }
+
+    for (int y = 0; y < a->height; y++) {
+        for (int x = 0; x < a->width; x++) {
+            if (pntr_image_get_color(a, x, y).value != pntr_image_get_color(b, x, y).value) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Renders the scene for a number of frames, and returns the median frame time in milliseconds.
+ */
+static double run_scene(const perf_scene* scene, pntr_font* font, pntr_image* screen) {
+    struct nk_context* ctx = pntr_load_nuklear(font);
+    pntr_image* image = pntr_gen_image_color(32, 32, PNTR_WHITE);
+    if (ctx == NULL || image == NULL) {
+        fprintf(stderr, "%s: out of memory\n", scene->name);
+        exit(1);
+    }
+    for (int y = 0; y < image->height; y++) {
+        for (int x = 0; x < image->width; x++) {
+            pntr_draw_point(image, x, y, ((x / 4 + y / 4) % 2 == 0) ? PNTR_RED : pntr_new_color((unsigned char)(x * 8), (unsigned char)(y * 8), 128, 255));
+        }
+    }
+
+    double times[PERF_FRAMES];
+    for (int frame = -PERF_WARMUP_FRAMES; frame < PERF_FRAMES; frame++) {
+        double start = seconds();
+        scene->build(ctx, image);
+        pntr_clear_background(screen, PNTR_DARKGRAY);
+        if (!pntr_draw_nuklear(screen, ctx)) {
+            fprintf(stderr, "%s: pntr_draw_nuklear() failed\n", scene->name);
+            exit(1);
+        }
+        if (frame >= 0) {
+            times[frame] = seconds() - start;
+        }
+    }
+
+    pntr_unload_image(image);
+    pntr_unload_nuklear(ctx);
+
+    qsort(times, PERF_FRAMES, sizeof(double), compare_doubles);
+    return (times[PERF_FRAMES / 2 - 1] + times[PERF_FRAMES / 2]) * 0.5 * 1000.0;
+}
+
+/**
+ * Compares the rendered frame against the golden image, or records it when updating.
+ */
+static bool check_golden(const char* path, pntr_image* screen, bool update) {
+    if (update) {
+        if (!pntr_save_image(screen, path)) {
+            fprintf(stderr, "Failed to save %s\n", path);
+            return false;
+        }
+        printf("Recorded golden image %s\n", path);
+        return true;
+    }
+
+    pntr_image* golden = pntr_load_image(path);
+    if (golden == NULL) {
+        fprintf(stderr, "Missing golden image %s, record it with PNTR_NUKLEAR_PERF_UPDATE=1\n", path);
+        return false;
+    }
+
+    bool equal = images_equal(screen, golden);
+    pntr_unload_image(golden);
+    if (!equal) {
+        fprintf(stderr, "Output differs from %s\n", path);
+    }
+    return equal;
+}
+
+/**
+ * Compares the median frame time against the baseline, or records it when updating.
+ */
+static bool check_baseline(const char* path, double median, double tolerance, bool update) {
+    FILE* file;
+    if (update) {
+        file = fopen(path, "w");
+        if (file == NULL) {
+            fprintf(stderr, "Failed to save %s\n", path);
+            return false;
+        }
+        fprintf(file, "%.4f\n", median);
+        fclose(file);
+        printf("Recorded baseline %.4f ms in %s\n", median, path);
+        return true;
+    }
+
+    file = fopen(path, "r");
+    if (file == NULL) {
+        fprintf(stderr, "Missing baseline %s, record it with PNTR_NUKLEAR_PERF_UPDATE=1\n", path);
+        return false;
+    }
+    double baseline = 0.0;
+    int read = fscanf(file, "%lf", &baseline);
+    fclose(file);
+    if (read != 1 || baseline <= 0.0) {
+        fprintf(stderr, "Invalid baseline in %s\n", path);
+        return false;
+    }
+
+    double limit = baseline * (1.0 + tolerance);
+    printf("Median frame %.4f ms, baseline %.4f ms, limit %.4f ms\n", median, baseline, limit);
+    if (median > limit) {
+        fprintf(stderr, "Frame time regressed by %.1f%%\n", (median / baseline - 1.0) * 100.0);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc < 3) {
+        fprintf(stderr, "Usage: %s <scene> <data directory> [tolerance]\n", argv[0]);
+        return 1;
+    }
+
+    const perf_scene* scene = NULL;
+    for (size_t i = 0; i < sizeof(scenes) / sizeof(scenes[0]); i++) {
+        if (strcmp(argv[1], scenes[i].name) == 0) {
+            scene = &scenes[i];
+        }
+    }
+    if (scene == NULL) {
+        fprintf(stderr, "Unknown scene %s\n", argv[1]);
+        return 1;
+    }
+
+    double tolerance = (argc > 3) ? atof(argv[3]) : PERF_DEFAULT_TOLERANCE;
+    const char* updateEnv = getenv("PNTR_NUKLEAR_PERF_UPDATE");
+    bool update = updateEnv != NULL && strcmp(updateEnv, "1") == 0;
+
+    pntr_font* font = pntr_load_font_default();
+    pntr_image* screen = pntr_gen_image_color(PERF_WIDTH, PERF_HEIGHT, PNTR_DARKGRAY);
+    if (font == NULL || screen == NULL) {
+        fprintf(stderr, "Failed to load the default font\n");
+        return 1;
+    }
+
+    double median = run_scene(scene, font, screen);
+
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/pntr_nuklear_perf_%s.png", argv[2], scene->name);
+    bool passed = check_golden(path, screen, update);
+    snprintf(path, sizeof(path), "%s/pntr_nuklear_perf_%s.txt", argv[2], scene->name);
+    passed = check_baseline(path, median, tolerance, update) && passed;
+
+    pntr_unload_image(screen);
+    pntr_unload_font(font);
+
+    return passed ? 0 : 1;
+}
@@ -1,4 +1,5 @@
 #include <stdio.h>
+#include <string.h>
 
 #define PNTR_DISABLE_MATH
 #define PNTR_IMPLEMENTATION
@@ -9,17 +10,9 @@
 #define PNTR_NUKLEAR_IMPLEMENTATION
 #include "pntr_nuklear.h"
 
-int main() {
-    pntr_font* font = pntr_load_font_default();
-    PNTR_ASSERT(font);
-
-    struct nk_context* ctx = pntr_load_nuklear(font);
-    PNTR_ASSERT(ctx);
-
-    enum {EASY, HARD};
-    static int op = EASY;
-    static float value = 0.6f;
+enum {EASY, HARD};
 
+static void build_ui(struct nk_context* ctx, int* op, float* value) {
     if (nk_begin(ctx, "pntr_nuklear Example", nk_rect(10, 10, 300, 200),
         NK_WINDOW_BORDER|NK_WINDOW_MOVABLE|NK_WINDOW_CLOSABLE)) {
         nk_layout_row_static(ctx, 30, 80, 1);
@@ -29,8 +22,8 @@ int main() {
 
         // Fixed widget window ratio width
         nk_layout_row_dynamic(ctx, 30, 2);
-        if (nk_option_label(ctx, "Easy", op == EASY)) op = EASY;
-        if (nk_option_label(ctx, "Hard", op == HARD)) op = HARD;
+        if (nk_option_label(ctx, "Easy", *op == EASY)) *op = EASY;
+        if (nk_option_label(ctx, "Hard", *op == HARD)) *op = HARD;
 
         // Custom widget pixel width
         nk_layout_row_begin(ctx, NK_STATIC, 30, 2);
@@ -38,11 +31,133 @@ int main() {
             nk_layout_row_push(ctx, 80);
             nk_label(ctx, "Volume:", NK_TEXT_LEFT);
             nk_layout_row_push(ctx, 110);
-            nk_slider_float(ctx, 0, &value, 1.0f, 0.1f);
+            nk_slider_float(ctx, 0, value, 1.0f, 0.1f);
         }
         nk_layout_row_end(ctx);
     }
     nk_end(ctx);
+}
+
+static float text_width(nk_handle font, float height, const char* text, int len) {
+    (void)height;
+    return len == 0 ? 0.0f : (float)pntr_measure_text_ex((pntr_font*)font.ptr, text, len).x;
+}
+
+static int allocations;
+
+static void* counting_alloc(nk_handle handle, void* old, nk_size size) {
+    (void)old;
+    (*(int*)handle.ptr)++;
+    return malloc(size);
+}
+
+static void counting_free(nk_handle handle, void* memory) {
+    (*(int*)handle.ptr)--;
+    free(memory);
+}
+
+static char clipboards[2][32];
+
+static void clipboard_copy(nk_handle usr, const char* text, int len) {
+    char* clipboard = (char*)usr.ptr;
+    int size = len < 31 ? len : 31;
+    memcpy(clipboard, text, (size_t)size);
+    clipboard[size] = '\0';
+}
+
+static void clipboard_paste(nk_handle usr, struct nk_text_edit* edit) {
+    nk_textedit_paste(edit, (const char*)usr.ptr, (int)strlen((const char*)usr.ptr));
+}
+
+static void copy_text(struct nk_context* ctx, pntr_image* dst, const char* text) {
+    char buffer[32];
+    strcpy(buffer, text);
+    nk_input_key(ctx, NK_KEY_TEXT_SELECT_ALL, nk_true);
+    nk_input_key(ctx, NK_KEY_COPY, nk_true);
+    if (nk_begin(ctx, "Clipboard", nk_rect(0, 0, 200, 100), NK_WINDOW_NO_SCROLLBAR)) {
+        nk_layout_row_dynamic(ctx, 30, 1);
+        nk_edit_focus(ctx, NK_EDIT_CLIPBOARD);
+        nk_edit_string_zero_terminated(ctx, NK_EDIT_FIELD|NK_EDIT_CLIPBOARD, buffer, sizeof(buffer), nk_filter_default);
+    }
+    nk_end(ctx);
+    PNTR_ASSERT(pntr_draw_nuklear(dst, ctx));
+    nk_input_key(ctx, NK_KEY_TEXT_SELECT_ALL, nk_false);
+    nk_input_key(ctx, NK_KEY_COPY, nk_false);
+}
+
+static void reverse_parallel_for(void* user, int count, void (*job)(void* data, int index), void* data) {
+    (*(int*)user) += count;
+    for (int i = count - 1; i >= 0; i--) {
+        job(data, i);
+    }
+}
+
+static void draw_unoptimized(pntr_image* dst, struct nk_context* ctx) {
+    const struct nk_command* cmd;
+    nk_input_end(ctx);
+    nk_foreach(cmd, ctx) {
+        pntr_nuklear_draw_command(dst, cmd, pntr_nuklear_get_context(ctx), 0);
+    }
+    pntr_image_set_clip(dst, 0, 0, dst->width, dst->height);
+    nk_clear(ctx);
+    nk_input_begin(ctx);
+}
+
+static void build_images(struct nk_context* ctx, pntr_image* image) {
+    if (nk_begin(ctx, "Images", nk_rect(0, 0, 200, 100), NK_WINDOW_NO_SCROLLBAR)) {
+        struct nk_command_buffer* canvas = nk_window_get_canvas(ctx);
+        struct nk_image img = pntr_image_nk(image);
+        nk_draw_image(canvas, nk_rect(20, 20, 8, 8), &img, nk_rgb(255, 255, 255));
+        nk_draw_image(canvas, nk_rect(60, 20, 16, 16), &img, nk_rgb(255, 255, 255));
+        nk_draw_image(canvas, nk_rect(100, 20, 12, 12), &img, nk_rgb(255, 255, 255));
+    }
+    nk_end(ctx);
+}
+
+static void draw_custom(void* canvas, short x, short y, unsigned short w, unsigned short h, nk_handle data) {
+    (void)canvas;
+    pntr_draw_rectangle_fill((pntr_image*)data.ptr, x, y, w, h, PNTR_RED);
+}
+
+static void build_custom(struct nk_context* ctx, pntr_image* dst) {
+    // The custom command reaches past its window, and under the window drawn after it.
+    if (nk_begin(ctx, "Custom", nk_rect(0, 0, 150, 120), NK_WINDOW_NO_SCROLLBAR)) {
+        nk_push_custom(nk_window_get_canvas(ctx), nk_rect(10, 10, 200, 100), draw_custom, nk_handle_ptr(dst));
+    }
+    nk_end(ctx);
+    if (nk_begin(ctx, "Above", nk_rect(80, 40, 150, 120), NK_WINDOW_BORDER)) {
+        nk_layout_row_dynamic(ctx, 20, 1);
+        nk_label(ctx, "Covers the custom command", NK_TEXT_LEFT);
+    }
+    nk_end(ctx);
+}
+
+static bool images_equal(pntr_image* a, pntr_image* b) {
+    if (a->width != b->width || a->height != b->height) {
+        return false;
+    }
+
+    for (int y = 0; y < a->height; y++) {
+        for (int x = 0; x < a->width; x++) {
+            if (pntr_image_get_color(a, x, y).value != pntr_image_get_color(b, x, y).value) {
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+int main() {
+    pntr_font* font = pntr_load_font_default();
+    PNTR_ASSERT(font);
+
+    struct nk_context* ctx = pntr_load_nuklear(font);
+    PNTR_ASSERT(ctx);
+
+    int op = EASY;
+    float value = 0.6f;
+    build_ui(ctx, &op, &value);
 
     // Build a screen
     pntr_image* image = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
@@ -54,10 +169,850 @@ int main() {
     // Save the image
     PNTR_ASSERT(pntr_save_image(image, "pntr_nuklear_test.png"));
 
+    // Text widths match pntr_measure_text_ex()
+    {
+        const struct nk_user_font* userFont = ctx->style.font;
+        const char* text = "Hello, World!\nThe quick brown fox";
+        for (int len = 0; len <= (int)strlen(text); len++) {
+            float expected = len == 0 ? 0.0f : (float)pntr_measure_text_ex(font, text, len).x;
+            PNTR_ASSERT_EQUALS(userFont->width(userFont->userdata, userFont->height, text, len), expected);
+        }
+
+        // Text that can't be summed from the advances is cached
+        const char* accented = "Caf\xc3\xa9";
+        float width = userFont->width(userFont->userdata, userFont->height, accented, 5);
+        PNTR_ASSERT_EQUALS(width, (float)pntr_measure_text_ex(font, accented, 5).x);
+        PNTR_ASSERT_EQUALS(userFont->width(userFont->userdata, userFont->height, accented, 5), width);
+        pntr_nuklear_stats stats = pntr_nuklear_get_stats(ctx);
+        PNTR_ASSERT_EQUALS(stats.textCacheMisses, 1);
+        PNTR_ASSERT_EQUALS(stats.textCacheHits, 1);
+
+        // Changing the font forgets the cached widths
+        pntr_nuklear_set_font(ctx, font);
+        PNTR_ASSERT(ctx->style.font->width == userFont->width);
+        userFont = ctx->style.font;
+        userFont->width(userFont->userdata, userFont->height, accented, 5);
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(ctx).textCacheMisses, 2);
+        pntr_nuklear_reset_stats(ctx);
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(ctx).textCacheHits, 0);
+    }
+
+    // Text blitted from the glyph atlas matches pntr_draw_text()
+    {
+        pntr_image* expected = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+
+        // A Nuklear font of its own is drawn with pntr_draw_text().
+        struct nk_user_font userFont = *ctx->style.font;
+        userFont.width = text_width;
+        userFont.userdata.ptr = font;
+        const struct nk_user_font* atlasFont = ctx->style.font;
+
+        nk_style_set_font(ctx, &userFont);
+        build_ui(ctx, &op, &value);
+        pntr_draw_nuklear(expected, ctx);
+        nk_style_set_font(ctx, atlasFont);
+        build_ui(ctx, &op, &value);
+        pntr_draw_nuklear(actual, ctx);
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+    }
+
+    // Span fills match pntr
+    {
+        pntr_image* expected = pntr_gen_image_color(64, 64, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(64, 64, PNTR_RAYWHITE);
+        pntr_color colors[] = { pntr_new_color(255, 0, 0, 255), pntr_new_color(0, 0, 255, 128), pntr_new_color(0, 255, 0, 0) };
+        for (int i = 0; i < 3; i++) {
+            pntr_draw_rectangle_fill(expected, 3 + i * 10, 5, 50, 40, colors[i]);
+            pntr_nuklear_fill_rect(actual, PNTR_CLITERAL(pntr_rectangle) { 3 + i * 10, 5, 50, 40 }, colors[i]);
+        }
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+    }
+
+    // Polygons are filled by their pixel centers, clipped
+    {
+        pntr_image* expected = pntr_gen_image_color(64, 64, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(64, 64, PNTR_RAYWHITE);
+        pntr_nuklear_scratch scratch = { NULL, 0 };
+        pntr_color color = pntr_new_color(0, 0, 255, 128);
+
+        struct nk_vec2i square[4] = { {5, 5}, {40, 5}, {40, 30}, {5, 30} };
+        pntr_draw_rectangle_fill(expected, 5, 5, 35, 25, color);
+        PNTR_ASSERT(pntr_nuklear_fill_polygon(actual, square, 4, color, &scratch));
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        // A triangle made of two halves of a square covers it exactly once
+        struct nk_vec2i upper[3] = { {20, 35}, {60, 35}, {60, 60} };
+        struct nk_vec2i lower[3] = { {20, 35}, {60, 60}, {20, 60} };
+        pntr_image_set_clip(expected, 0, 0, 50, 64);
+        pntr_image_set_clip(actual, 0, 0, 50, 64);
+        pntr_draw_rectangle_fill(expected, 20, 35, 40, 25, color);
+        PNTR_ASSERT(pntr_nuklear_fill_polygon(actual, upper, 3, color, &scratch));
+        PNTR_ASSERT(pntr_nuklear_fill_polygon(actual, lower, 3, color, &scratch));
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        // Slanted edges only differ from pntr_draw_polygon_fill() where the two round the edge crossings differently,
+        // so every differing pixel is within two pixels of the edge.
+        struct nk_vec2i slanted[5] = { {7, 3}, {58, 20}, {30, 28}, {44, 58}, {3, 40} };
+        pntr_vector slantedPoints[5];
+        for (int i = 0; i < 5; i++) {
+            slantedPoints[i] = pntr_nk_vec2i_to_vector(slanted[i]);
+        }
+        pntr_image_set_clip(expected, 0, 0, 64, 64);
+        pntr_image_set_clip(actual, 0, 0, 64, 64);
+        pntr_clear_background(expected, PNTR_RAYWHITE);
+        pntr_clear_background(actual, PNTR_RAYWHITE);
+        pntr_draw_polygon_fill(expected, slantedPoints, 5, PNTR_RED);
+        PNTR_ASSERT(pntr_nuklear_fill_polygon(actual, slanted, 5, PNTR_RED, &scratch));
+        for (int y = 0; y < 64; y++) {
+            for (int x = 0; x < 64; x++) {
+                if (pntr_image_get_color(expected, x, y).value == pntr_image_get_color(actual, x, y).value) {
+                    continue;
+                }
+                int filled = 0;
+                int checked = 0;
+                for (int dy = -2; dy <= 2; dy++) {
+                    for (int dx = -2; dx <= 2; dx++) {
+                        if (x + dx >= 0 && x + dx < 64 && y + dy >= 0 && y + dy < 64) {
+                            filled += pntr_image_get_color(actual, x + dx, y + dy).value == PNTR_RED.value;
+                            checked++;
+                        }
+                    }
+                }
+                PNTR_ASSERT(filled > 0 && filled < checked);
+            }
+        }
+
+        // pntr_nuklear_draw_polygon_fill() fills any number of points the same way, reusing its scratch memory
+        struct nk_vec2i circle[200];
+        for (int i = 0; i < 200; i++) {
+            float angle = (float)i * 2.0f * PNTR_PI / 200.0f;
+            circle[i].x = (short)(32.0f + 28.0f * PNTR_COSF(angle));
+            circle[i].y = (short)(32.0f + 28.0f * PNTR_SINF(angle));
+        }
+        pntr_clear_background(expected, PNTR_RAYWHITE);
+        pntr_clear_background(actual, PNTR_RAYWHITE);
+        PNTR_ASSERT(pntr_nuklear_fill_polygon(expected, circle, 200, color, &scratch));
+        pntr_nuklear_draw_polygon_fill(actual, circle, 200, color);
+        PNTR_ASSERT(images_equal(expected, actual));
+        void* polygonMemory = pntr_nuklear_polygon_scratch.memory;
+        pntr_nuklear_draw_polygon_fill(actual, circle, 200, color);
+        PNTR_ASSERT(polygonMemory != NULL && pntr_nuklear_polygon_scratch.memory == polygonMemory);
+
+        pntr_unload_memory(scratch.memory);
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+    }
+
+    // Curves and arcs are flattened by their size
+    {
+        struct nk_command_curve line;
+        PNTR_MEMSET(&line, 0, sizeof(line));
+        line.begin.x = 0;
+        line.begin.y = 0;
+        line.ctrl[0].x = 10;
+        line.ctrl[0].y = 10;
+        line.ctrl[1].x = 20;
+        line.ctrl[1].y = 20;
+        line.end.x = 30;
+        line.end.y = 30;
+        PNTR_ASSERT_EQUALS(pntr_nuklear_curve_segments(&line, PNTR_NUKLEAR_CURVE_TOLERANCE), 1);
+        line.ctrl[1].x = 200;
+        line.ctrl[1].y = 0;
+        PNTR_ASSERT(pntr_nuklear_curve_segments(&line, PNTR_NUKLEAR_CURVE_TOLERANCE) > pntr_nuklear_curve_segments(&line, 4.0f));
+
+        int small = pntr_nuklear_arc_segments(4.0f, 0.0f, 2.0f * PNTR_PI, PNTR_NUKLEAR_CURVE_TOLERANCE);
+        int large = pntr_nuklear_arc_segments(100.0f, 0.0f, 2.0f * PNTR_PI, PNTR_NUKLEAR_CURVE_TOLERANCE);
+        PNTR_ASSERT(small < large);
+        PNTR_ASSERT(large < 100 * 3);
+
+        pntr_nuklear_set_curve_tolerance(ctx, 1.0f);
+        PNTR_ASSERT(pntr_nuklear_get_context(ctx)->curveTolerance == 1.0f);
+        pntr_nuklear_set_curve_tolerance(ctx, PNTR_NUKLEAR_CURVE_TOLERANCE);
+    }
+
+    // Incremental rendering matches a full redraw
+    {
+        struct nk_context* incremental = pntr_load_nuklear(font);
+        PNTR_ASSERT(incremental);
+        pntr_image* expected = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(320, 220, PNTR_BLACK);
+
+        int incrementalOp = EASY;
+        float incrementalValue = 0.6f;
+        build_ui(incremental, &incrementalOp, &incrementalValue);
+        PNTR_ASSERT(pntr_draw_nuklear_incremental(actual, incremental, PNTR_RAYWHITE));
+        PNTR_ASSERT(images_equal(image, actual));
+
+        // Nothing changed
+        build_ui(incremental, &incrementalOp, &incrementalValue);
+        PNTR_ASSERT(!pntr_draw_nuklear_incremental(actual, incremental, PNTR_RAYWHITE));
+        PNTR_ASSERT(images_equal(image, actual));
+
+        // Only the changes are redrawn
+        value = incrementalValue = 0.2f;
+        op = incrementalOp = HARD;
+        build_ui(ctx, &op, &value);
+        pntr_draw_nuklear(expected, ctx);
+        build_ui(incremental, &incrementalOp, &incrementalValue);
+        PNTR_ASSERT(pntr_draw_nuklear_incremental(actual, incremental, PNTR_RAYWHITE));
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+        pntr_unload_nuklear(incremental);
+    }
+
+    // Tiled rendering matches a full redraw
+    {
+        pntr_image* expected = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+
+        build_ui(ctx, &op, &value);
+        pntr_draw_nuklear(expected, ctx);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_tiled(actual, ctx, 4));
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        // The worker threads are kept for the next frame.
+        #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        PNTR_ASSERT_EQUALS(pntr_nuklear_threads.threadCount, 3);
+        pthread_t worker = pntr_nuklear_threads.threads[1];
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_tiled(actual, ctx, 4));
+        PNTR_ASSERT(pthread_equal(worker, pntr_nuklear_threads.threads[1]));
+        PNTR_ASSERT(images_equal(expected, actual));
+        #endif
+
+        // Custom commands keep their place and clip among the tiles
+        pntr_clear_background(expected, PNTR_RAYWHITE);
+        pntr_clear_background(actual, PNTR_RAYWHITE);
+        build_custom(ctx, expected);
+        PNTR_ASSERT(pntr_draw_nuklear(expected, ctx));
+        build_custom(ctx, actual);
+        PNTR_ASSERT(pntr_draw_nuklear_tiled(actual, ctx, 4));
+        PNTR_ASSERT(images_equal(expected, actual));
+        PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, 60, 60).value, PNTR_RED.value);
+        PNTR_ASSERT(pntr_image_get_color(actual, 140, 60).value != PNTR_RED.value);
+        PNTR_ASSERT(pntr_image_get_color(actual, 160, 20).value != PNTR_RED.value);
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+    }
+
+    // Layered rendering matches a full redraw
+    {
+        pntr_image* expected = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+
+        build_ui(ctx, &op, &value);
+        pntr_draw_nuklear(expected, ctx);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_layered(actual, ctx));
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        // The cached layer is reused
+        pntr_clear_background(actual, PNTR_RAYWHITE);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_layered(actual, ctx));
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        // Translucent windows don't have their alpha applied twice
+        struct nk_style_item background = ctx->style.window.fixed_background;
+        ctx->style.window.fixed_background = nk_style_item_color(nk_rgba(40, 40, 40, 128));
+        for (int frame = 0; frame < 2; frame++) {
+            pntr_clear_background(expected, pntr_new_color(30, 120, 200, 255));
+            pntr_clear_background(actual, pntr_new_color(30, 120, 200, 255));
+            build_ui(ctx, &op, &value);
+            pntr_draw_nuklear(expected, ctx);
+            build_ui(ctx, &op, &value);
+            PNTR_ASSERT(pntr_draw_nuklear_layered(actual, ctx));
+            PNTR_ASSERT(images_equal(expected, actual));
+        }
+        ctx->style.window.fixed_background = background;
+
+        // Custom commands are drawn with their window, under the windows after it
+        for (int frame = 0; frame < 2; frame++) {
+            pntr_clear_background(expected, PNTR_RAYWHITE);
+            pntr_clear_background(actual, PNTR_RAYWHITE);
+            build_custom(ctx, expected);
+            PNTR_ASSERT(pntr_draw_nuklear(expected, ctx));
+            build_custom(ctx, actual);
+            PNTR_ASSERT(pntr_draw_nuklear_layered(actual, ctx));
+            PNTR_ASSERT(images_equal(expected, actual));
+            PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, 60, 60).value, PNTR_RED.value);
+        }
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+    }
+
+    // Commands under opaque windows are culled without changing the output
+    {
+        struct nk_context* reference = pntr_load_nuklear(font);
+        PNTR_ASSERT(reference);
+        pntr_image* expected = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+
+        // Draw the reference without culling, one command at a time.
+        build_ui(reference, &op, &value);
+        if (nk_begin(reference, "Cover", nk_rect(0, 0, 320, 220), NK_WINDOW_NO_SCROLLBAR)) {
+            nk_layout_row_dynamic(reference, 30, 1);
+            nk_label(reference, "On top", NK_TEXT_LEFT);
+        }
+        nk_end(reference);
+        draw_unoptimized(expected, reference);
+
+        pntr_nuklear_reset_stats(ctx);
+        build_ui(ctx, &op, &value);
+        if (nk_begin(ctx, "Cover", nk_rect(0, 0, 320, 220), NK_WINDOW_NO_SCROLLBAR)) {
+            nk_layout_row_dynamic(ctx, 30, 1);
+            nk_label(ctx, "On top", NK_TEXT_LEFT);
+        }
+        nk_end(ctx);
+        PNTR_ASSERT(pntr_draw_nuklear(actual, ctx));
+        PNTR_ASSERT(images_equal(expected, actual));
+        PNTR_ASSERT(pntr_nuklear_get_stats(ctx).culledCommands > 0);
+
+        // Close the cover
+        nk_window_close(ctx, "Cover");
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+        pntr_unload_nuklear(reference);
+    }
+
+    // Clipped and invisible commands are dropped without changing the output
+    {
+        struct nk_context* reference = pntr_load_nuklear(font);
+        struct nk_context* optimized = pntr_load_nuklear(font);
+        PNTR_ASSERT(reference && optimized);
+        pntr_image* expected = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+
+        struct nk_context* contexts[] = { reference, optimized };
+        for (int i = 0; i < 2; i++) {
+            if (nk_begin(contexts[i], "List", nk_rect(20, 20, 200, 100), NK_WINDOW_BORDER)) {
+                nk_layout_row_dynamic(contexts[i], 20, 1);
+                for (int row = 0; row < 30; row++) {
+                    nk_label(contexts[i], "Scrolled out", NK_TEXT_LEFT);
+                }
+                nk_stroke_line(nk_window_get_canvas(contexts[i]), 250, 150, 300, 200, 1, nk_rgb(255, 0, 0));
+            }
+            nk_end(contexts[i]);
+        }
+        draw_unoptimized(expected, reference);
+        PNTR_ASSERT(pntr_draw_nuklear(actual, optimized));
+        PNTR_ASSERT(images_equal(expected, actual));
+        PNTR_ASSERT(pntr_nuklear_get_stats(optimized).droppedCommands > 0);
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+        pntr_unload_nuklear(reference);
+        pntr_unload_nuklear(optimized);
+    }
+
+    // Polylines aren't limited in their number of points
+    {
+        struct nk_context* plot = pntr_load_nuklear(font);
+        PNTR_ASSERT(plot);
+        pntr_image* actual = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+
+        float points[400];
+        for (int i = 0; i < 200; i++) {
+            points[i * 2] = (float)(10 + i);
+            points[i * 2 + 1] = 100.0f;
+        }
+        if (nk_begin(plot, "Plot", nk_rect(0, 0, 320, 220), NK_WINDOW_NO_SCROLLBAR)) {
+            nk_stroke_polyline(nk_window_get_canvas(plot), points, 200, 1, nk_rgb(255, 0, 0));
+        }
+        nk_end(plot);
+        PNTR_ASSERT(pntr_draw_nuklear(actual, plot));
+        PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, 205, 100).value, pntr_new_color(255, 0, 0, 255).value);
+
+        pntr_unload_image(actual);
+        pntr_unload_nuklear(plot);
+    }
+
+    // Images are drawn as is, or rescaled once
+    {
+        struct nk_context* images = pntr_load_nuklear(font);
+        PNTR_ASSERT(images);
+        pntr_image* image = pntr_gen_image_color(8, 8, PNTR_RAYWHITE);
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                pntr_draw_point(image, x, y, pntr_new_color((unsigned char)(x * 30), (unsigned char)(y * 30), 0, 255));
+            }
+        }
+        pntr_image* expected = pntr_gen_image_color(200, 100, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(200, 100, PNTR_RAYWHITE);
+
+        build_images(images, image);
+        PNTR_ASSERT(pntr_draw_nuklear(expected, images));
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                PNTR_ASSERT_EQUALS(pntr_image_get_color(expected, 20 + x, 20 + y).value, pntr_image_get_color(image, x, y).value);
+            }
+        }
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(images).imageCacheMisses, 2);
+
+        // The rescaled images are reused, including by the threads of the tiled renderer
+        build_images(images, image);
+        PNTR_ASSERT(pntr_draw_nuklear_tiled(actual, images, 4));
+        PNTR_ASSERT(images_equal(expected, actual));
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(images).imageCacheMisses, 2);
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(images).imageCacheHits, 2);
+
+        // Tinted and rescaled images draw the same as pntr does, tinting after rescaling
+        {
+            pntr_color tint = pntr_new_color(200, 120, 60, 255);
+            pntr_image* direct = pntr_gen_image_color(200, 100, PNTR_RAYWHITE);
+            pntr_draw_image_scaled_rec(direct, image, PNTR_CLITERAL(pntr_rectangle) { 0, 0, 8, 8 }, 60, 20, 2.0f, 2.0f, 0, 0, PNTR_FILTER_BILINEAR, tint);
+            pntr_draw_image_scaled_rec(direct, image, PNTR_CLITERAL(pntr_rectangle) { 0, 0, 8, 8 }, 100, 20, 1.5f, 1.5f, 0, 0, PNTR_FILTER_BILINEAR, tint);
+            if (nk_begin(images, "Images", nk_rect(0, 0, 200, 100), NK_WINDOW_NO_SCROLLBAR)) {
+                struct nk_image img = pntr_image_nk(image);
+                nk_draw_image(nk_window_get_canvas(images), nk_rect(60, 20, 16, 16), &img, nk_rgb(200, 120, 60));
+                nk_draw_image(nk_window_get_canvas(images), nk_rect(100, 20, 12, 12), &img, nk_rgb(200, 120, 60));
+            }
+            nk_end(images);
+            PNTR_ASSERT(pntr_draw_nuklear(actual, images));
+            for (int y = 20; y < 36; y++) {
+                for (int x = 60; x < 76; x++) {
+                    PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, x, y).value, pntr_image_get_color(direct, x, y).value);
+                }
+            }
+            for (int y = 20; y < 32; y++) {
+                for (int x = 100; x < 112; x++) {
+                    PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, x, y).value, pntr_image_get_color(direct, x, y).value);
+                }
+            }
+
+            // The tint is applied as the copy is drawn, so the untinted copies are reused.
+            PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(images).imageCacheMisses, 2);
+            pntr_unload_image(direct);
+        }
+
+        // Images changed in place keep drawing their rescaled copy until they are invalidated
+        pntr_clear_background(image, pntr_new_color(0, 0, 255, 255));
+        build_images(images, image);
+        PNTR_ASSERT(pntr_draw_nuklear(actual, images));
+        for (int y = 20; y < 32; y++) {
+            for (int x = 100; x < 112; x++) {
+                PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, x, y).value, pntr_image_get_color(expected, x, y).value);
+            }
+        }
+        pntr_nuklear_invalidate_image(images, image);
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_context(images)->imageCacheCount, 0);
+        build_images(images, image);
+        PNTR_ASSERT(pntr_draw_nuklear(actual, images));
+        PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, 105, 25).value, pntr_new_color(0, 0, 255, 255).value);
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(images).imageCacheMisses, 4);
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+        pntr_unload_image(image);
+        pntr_unload_nuklear(images);
+    }
+
+    // Images drawn much smaller than they are sample from their mipmap, so no detail is skipped
+    {
+        struct nk_context* mipmaps = pntr_load_nuklear(font);
+        PNTR_ASSERT(mipmaps);
+        pntr_image* checkers = pntr_gen_image_color(64, 64, PNTR_BLACK);
+        for (int y = 0; y < 64; y++) {
+            for (int x = (y & 1); x < 64; x += 2) {
+                pntr_draw_point(checkers, x, y, PNTR_WHITE);
+            }
+        }
+        pntr_image* expected = pntr_gen_image_color(100, 100, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(100, 100, PNTR_RAYWHITE);
+
+        for (int pass = 0; pass < 2; pass++) {
+            if (nk_begin(mipmaps, "Mipmaps", nk_rect(0, 0, 100, 100), NK_WINDOW_NO_SCROLLBAR)) {
+                nk_draw_image(nk_window_get_canvas(mipmaps), nk_rect(20, 20, 6, 6), &(struct nk_image) { .handle = { .ptr = checkers }, .w = 64, .h = 64, .region = { 0, 0, 64, 64 } }, nk_rgb(255, 255, 255));
+            }
+            nk_end(mipmaps);
+            PNTR_ASSERT(pass == 0 ? pntr_draw_nuklear(expected, mipmaps) : pntr_draw_nuklear_tiled(actual, mipmaps, 4));
+        }
+        for (int y = 20; y < 26; y++) {
+            for (int x = 20; x < 26; x++) {
+                pntr_color color = pntr_image_get_color(expected, x, y);
+                PNTR_ASSERT(color.rgba.r > 120 && color.rgba.r < 136);
+            }
+        }
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+        pntr_unload_image(checkers);
+        pntr_unload_nuklear(mipmaps);
+    }
+
+    // Frames drawing more rescaled images than the image cache holds draw the same with threads
+    {
+        struct nk_context* many = pntr_load_nuklear(font);
+        PNTR_ASSERT(many);
+        pntr_image* image = pntr_gen_image_color(8, 8, PNTR_RAYWHITE);
+        for (int y = 0; y < 8; y++) {
+            for (int x = 0; x < 8; x++) {
+                pntr_draw_point(image, x, y, pntr_new_color((unsigned char)(x * 30), (unsigned char)(y * 30), 200, 255));
+            }
+        }
+        pntr_image* expected = pntr_gen_image_color(300, 300, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(300, 300, PNTR_RAYWHITE);
+        const int count = PNTR_NUKLEAR_IMAGE_CACHE_SIZE + 8;
+
+        for (int pass = 0; pass < 2; pass++) {
+            if (nk_begin(many, "Many", nk_rect(0, 0, 300, 300), NK_WINDOW_NO_SCROLLBAR)) {
+                for (int i = 0; i < count; i++) {
+                    struct nk_rect rect = nk_rect((float)(i % 6 * 48), (float)(i / 6 * 48), (float)(10 + i), (float)(11 + i * 2 % 30));
+                    nk_draw_image(nk_window_get_canvas(many), rect, &(struct nk_image) { .handle = { .ptr = image }, .w = 8, .h = 8, .region = { 0, 0, 8, 8 } }, nk_rgb(255, 255, 255));
+                }
+            }
+            nk_end(many);
+            PNTR_ASSERT(pass == 0 ? pntr_draw_nuklear(expected, many) : pntr_draw_nuklear_tiled(actual, many, 4));
+        }
+        PNTR_ASSERT(images_equal(expected, actual));
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(many).imageCacheMisses, (unsigned int)count);
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(many).imageCacheHits, (unsigned int)count);
+
+        // Once frames stop drawing them, the cache goes back to its size
+        for (int frame = 0; frame < 2; frame++) {
+            PNTR_ASSERT(pntr_draw_nuklear(actual, many));
+        }
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_context(many)->imageCacheCount, PNTR_NUKLEAR_IMAGE_CACHE_SIZE);
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+        pntr_unload_image(image);
+        pntr_unload_nuklear(many);
+    }
+
+    // Nuklear's memory comes from a fixed block, and frames that don't fit in it aren't drawn
+    {
+        static char memory[64 * 1024];
+        struct nk_context* fixed = pntr_load_nuklear_fixed(font, memory, sizeof(memory));
+        PNTR_ASSERT(fixed);
+        pntr_image* expected = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear(expected, ctx));
+        build_ui(fixed, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear(actual, fixed));
+        PNTR_ASSERT(images_equal(expected, actual));
+        nk_size used = pntr_nuklear_get_memory_used(fixed);
+        PNTR_ASSERT(used > 0 && used <= sizeof(memory));
+        pntr_unload_nuklear(fixed);
+
+        // Commands that no longer fit leave the image as is.
+        fixed = pntr_load_nuklear_fixed(font, memory, used - 64);
+        PNTR_ASSERT(fixed);
+        pntr_clear_background(actual, PNTR_RAYWHITE);
+        build_ui(fixed, &op, &value);
+        PNTR_ASSERT(!pntr_draw_nuklear(actual, fixed));
+        PNTR_ASSERT(pntr_nuklear_get_memory_used(fixed) > used - 64);
+        PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, 20, 20).value, PNTR_RAYWHITE.value);
+
+        // Smaller frames after it are drawn again.
+        for (int frame = 0; frame < 3; frame++) {
+            if (nk_begin(fixed, "Small", nk_rect(10, 10, 100, 60), NK_WINDOW_BORDER)) {
+                nk_layout_row_dynamic(fixed, 20, 1);
+                nk_label(fixed, "Small", NK_TEXT_LEFT);
+            }
+            nk_end(fixed);
+            PNTR_ASSERT(pntr_draw_nuklear(actual, fixed));
+            PNTR_ASSERT(pntr_nuklear_get_memory_used(fixed) < used - 64);
+        }
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+        pntr_unload_nuklear(fixed);
+    }
+
+    // The command buffer fits the busiest recent frame, and shrinks once frames need less
+    {
+        pntr_nuklear_allocator allocator = { 0 };
+        allocator.allocator.userdata.ptr = &allocations;
+        allocator.allocator.alloc = counting_alloc;
+        allocator.allocator.free = counting_free;
+        allocator.historyFrames = 2;
+        allocator.growStep = 256;
+        allocator.shrinkAfter = 2;
+        struct nk_context* arena = pntr_load_nuklear_ex(font, &allocator);
+        PNTR_ASSERT(arena);
+        PNTR_ASSERT_EQUALS(arena->memory.memory.size, 256);
+        pntr_image* canvas = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+
+        for (int frame = 0; frame < 2; frame++) {
+            build_ui(arena, &op, &value);
+            pntr_draw_nuklear(canvas, arena);
+        }
+        nk_size busy = arena->memory.memory.size;
+        PNTR_ASSERT(busy % 256 == 0 && busy > 256 && busy >= pntr_nuklear_get_memory_used(arena));
+
+        // Frames that fit make no allocations.
+        int live = allocations;
+        build_ui(arena, &op, &value);
+        pntr_draw_nuklear(canvas, arena);
+        PNTR_ASSERT_EQUALS(allocations, live);
+        PNTR_ASSERT_EQUALS(arena->memory.memory.size, busy);
+
+        // Memory stats are counted through the allocator
+        pntr_nuklear_memory_stats memory = pntr_nuklear_get_memory_stats(arena);
+        PNTR_ASSERT_EQUALS(memory.allocations - memory.frees, (unsigned int)allocations);
+        PNTR_ASSERT(memory.liveBytes > busy && memory.peakBytes >= memory.liveBytes);
+        PNTR_ASSERT_EQUALS(memory.commandBufferSize, busy);
+        PNTR_ASSERT(memory.commandBufferUsed > 256 && memory.commandBufferUsed <= busy);
+        PNTR_ASSERT_EQUALS(memory.windowCount, 1);
+        PNTR_ASSERT(memory.pageElementsUsed > 0 && memory.pageElementsUsed <= memory.pageElementsAllocated);
+
+        for (int frame = 0; frame < 4; frame++) {
+            pntr_draw_nuklear(canvas, arena);
+        }
+        PNTR_ASSERT_EQUALS(arena->memory.memory.size, 256);
+
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_memory_stats(arena).windowCount, 0);
+
+        pntr_unload_image(canvas);
+        pntr_unload_nuklear(arena);
+        PNTR_ASSERT_EQUALS(allocations, 0);
+    }
+
+    // Many contexts drawn on their own images across threads
+    {
+        struct nk_context* contexts[3];
+        pntr_image* images[3];
+        for (int i = 0; i < 3; i++) {
+            contexts[i] = pntr_load_nuklear(font);
+            PNTR_ASSERT(contexts[i]);
+            images[i] = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+            float volume = (float)i * 0.3f;
+            build_ui(contexts[i], &op, &volume);
+        }
+        #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        pthread_t worker = pntr_nuklear_threads.threads[1];
+        #endif
+        PNTR_ASSERT_EQUALS(pntr_draw_nuklear_batch(images, contexts, 3, 3), 3);
+
+        // The batch runs on the worker threads kept by the tiled renderer.
+        #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+        PNTR_ASSERT(pthread_equal(worker, pntr_nuklear_threads.threads[1]));
+        PNTR_ASSERT_EQUALS(pntr_nuklear_threads.threadCount, 3);
+        #endif
+
+        for (int i = 0; i < 3; i++) {
+            pntr_image* expected = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+            float volume = (float)i * 0.3f;
+            build_ui(contexts[i], &op, &volume);
+            PNTR_ASSERT(pntr_draw_nuklear(expected, contexts[i]));
+            PNTR_ASSERT(images_equal(expected, images[i]));
+            pntr_unload_image(expected);
+            pntr_unload_image(images[i]);
+            pntr_unload_nuklear(contexts[i]);
+        }
+    }
+
+    // Horizontal bands drawn through the caller's parallel for loop
+    {
+        pntr_image* expected = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear(expected, ctx));
+
+        int jobs = 0;
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_parallel(actual, ctx, reverse_parallel_for, &jobs));
+        PNTR_ASSERT_EQUALS(jobs, 8);
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        // Custom commands keep their place and clip among the bands
+        pntr_clear_background(expected, PNTR_RAYWHITE);
+        pntr_clear_background(actual, PNTR_RAYWHITE);
+        build_custom(ctx, expected);
+        PNTR_ASSERT(pntr_draw_nuklear(expected, ctx));
+        build_custom(ctx, actual);
+        PNTR_ASSERT(pntr_draw_nuklear_parallel(actual, ctx, reverse_parallel_for, &jobs));
+        PNTR_ASSERT(images_equal(expected, actual));
+        PNTR_ASSERT_EQUALS(pntr_image_get_color(actual, 60, 60).value, PNTR_RED.value);
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+    }
+
+    // Building the next frame while the last one is drawn
+    {
+        pntr_image* expected = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+        pntr_image* actual = pntr_gen_image_color(400, 225, PNTR_RAYWHITE);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear(expected, ctx));
+
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_async(actual, ctx));
+        build_ui(ctx, &op, &value);
+        pntr_nuklear_wait(ctx);
+        PNTR_ASSERT(images_equal(expected, actual));
+        #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+            PNTR_ASSERT(pntr_nuklear_get_context(ctx)->frameThreadStarted);
+            pthread_t renderThread = pntr_nuklear_get_context(ctx)->frameThread;
+        #endif
+
+        // The next frame waits for the one being drawn.
+        pntr_clear_background(actual, PNTR_RAYWHITE);
+        PNTR_ASSERT(pntr_draw_nuklear_async(actual, ctx));
+        PNTR_ASSERT(pntr_draw_nuklear(image, ctx));
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        // Reading or changing the counters and settings waits for it too.
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_async(actual, ctx));
+        pntr_nuklear_get_stats(ctx);
+        PNTR_ASSERT(!pntr_nuklear_get_context(ctx)->frameDrawing);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_async(actual, ctx));
+        pntr_nuklear_reset_stats(ctx);
+        PNTR_ASSERT(!pntr_nuklear_get_context(ctx)->frameDrawing);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear_async(actual, ctx));
+        pntr_nuklear_set_skip_unchanged(ctx, false);
+        PNTR_ASSERT(!pntr_nuklear_get_context(ctx)->frameDrawing);
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        // Every frame is drawn by the same render thread.
+        #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+            PNTR_ASSERT(pthread_equal(renderThread, pntr_nuklear_get_context(ctx)->frameThread));
+        #endif
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+    }
+
+    // Contexts keep their own state
+    {
+        struct nk_context* other = pntr_load_nuklear(font);
+        PNTR_ASSERT(other);
+        pntr_nuklear_memory_stats before = pntr_nuklear_get_memory_stats(ctx);
+        build_ui(other, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear(image, other));
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_memory_stats(other).windowCount, 1);
+        pntr_nuklear_memory_stats after = pntr_nuklear_get_memory_stats(ctx);
+        PNTR_ASSERT_EQUALS(before.allocations, after.allocations);
+        PNTR_ASSERT_EQUALS(before.liveBytes, after.liveBytes);
+        PNTR_ASSERT_EQUALS(before.windowCount, after.windowCount);
+
+        // Each context copies to the clipboard of its own app, as pntr_nuklear_update() wires it
+        struct nk_context* contexts[2] = { ctx, other };
+        const char* texts[2] = { "first", "second" };
+        for (int i = 0; i < 2; i++) {
+            contexts[i]->clip.userdata.ptr = clipboards[i];
+            contexts[i]->clip.copy = clipboard_copy;
+            contexts[i]->clip.paste = clipboard_paste;
+        }
+        for (int i = 0; i < 2; i++) {
+            copy_text(contexts[i], image, texts[i]);
+        }
+        PNTR_ASSERT(strcmp(clipboards[0], "first") == 0);
+        PNTR_ASSERT(strcmp(clipboards[1], "second") == 0);
+        for (int i = 0; i < 2; i++) {
+            contexts[i]->clip.userdata.ptr = NULL;
+            contexts[i]->clip.copy = NULL;
+            contexts[i]->clip.paste = NULL;
+        }
+
+        // Each context times double clicks on its own, even when clicked in turn
+        for (int i = 0; i < 2; i++) {
+            pntr_nuklear_double_click(contexts[i], true, true, 5, 5);
+            PNTR_ASSERT(!contexts[i]->input.mouse.buttons[NK_BUTTON_DOUBLE].down);
+            pntr_nuklear_double_click(contexts[i], false, false, 5, 5);
+        }
+        *pntr_nuklear_double_click_timer(ctx) += PNTR_NUKLEAR_DOUBLE_CLICK_TIME * 0.5f;
+        *pntr_nuklear_double_click_timer(other) += PNTR_NUKLEAR_DOUBLE_CLICK_TIME * 2.0f;
+        for (int i = 0; i < 2; i++) {
+            pntr_nuklear_double_click(contexts[i], true, true, 5, 5);
+        }
+        PNTR_ASSERT(contexts[0]->input.mouse.buttons[NK_BUTTON_DOUBLE].down);
+        PNTR_ASSERT(!contexts[1]->input.mouse.buttons[NK_BUTTON_DOUBLE].down);
+        for (int i = 0; i < 2; i++) {
+            pntr_nuklear_double_click(contexts[i], false, false, 5, 5);
+            PNTR_ASSERT(!contexts[i]->input.mouse.buttons[NK_BUTTON_DOUBLE].down);
+        }
+
+        pntr_unload_nuklear(other);
+    }
+
+    // Contexts set up with Nuklear's own nk_init functions are drawn without any state
+    {
+        struct nk_user_font userFont = *ctx->style.font;
+        userFont.width = text_width;
+        userFont.userdata.ptr = font;
+        const struct nk_user_font* atlasFont = ctx->style.font;
+        pntr_image* expected = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+        nk_style_set_font(ctx, &userFont);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear(expected, ctx));
+        nk_style_set_font(ctx, atlasFont);
+
+        struct nk_allocator allocator;
+        allocator.userdata.ptr = &allocations;
+        allocator.alloc = counting_alloc;
+        allocator.free = counting_free;
+        struct nk_context foreign;
+        PNTR_ASSERT(nk_init(&foreign, &allocator, &userFont));
+        nk_input_begin(&foreign);
+        build_ui(&foreign, &op, &value);
+        pntr_image* actual = pntr_gen_image_color(320, 220, PNTR_RAYWHITE);
+        PNTR_ASSERT(pntr_draw_nuklear(actual, &foreign));
+        PNTR_ASSERT(images_equal(expected, actual));
+
+        build_ui(&foreign, &op, &value);
+        pntr_clear_background(actual, PNTR_RAYWHITE);
+        PNTR_ASSERT(pntr_draw_nuklear_tiled(actual, &foreign, 4));
+        PNTR_ASSERT(images_equal(expected, actual));
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_stats(&foreign).culledCommands, 0);
+        PNTR_ASSERT_EQUALS(pntr_nuklear_get_memory_stats(&foreign).windowCount, 1);
+
+        // Unloading leaves it to whoever set it up.
+        pntr_unload_nuklear(&foreign);
+        nk_free(&foreign);
+        PNTR_ASSERT_EQUALS(allocations, 0);
+
+        pntr_unload_image(expected);
+        pntr_unload_image(actual);
+    }
+
+    // Skipping unchanged frames
+    {
+        pntr_nuklear_set_skip_unchanged(ctx, true);
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear(image, ctx));
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(!pntr_draw_nuklear(image, ctx));
+
+        value = 0.8f;
+        build_ui(ctx, &op, &value);
+        PNTR_ASSERT(pntr_draw_nuklear(image, ctx));
+
+        build_ui(ctx, &op, &value);
+        pntr_nuklear_invalidate(ctx);
+        PNTR_ASSERT(pntr_draw_nuklear(image, ctx));
+        pntr_nuklear_set_skip_unchanged(ctx, false);
+    }
+
     // Unload
     pntr_unload_font(font);
     pntr_unload_image(image);
     pntr_unload_nuklear(ctx);
 
+    // The worker threads stop along with the last context.
+    #ifdef PNTR_NUKLEAR_ENABLE_THREADS
+    PNTR_ASSERT_EQUALS(pntr_nuklear_threads.threadCount, 0);
+    #endif
+
     return 0;
 }